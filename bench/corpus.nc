@@ -0,0 +1,668 @@
+(pocket_and_profile.nc - post: generic fanuc-like, metric)
+(T1 D=6. CR=0. - ZMIN=-6. - flat end mill)
+N10 G90 G94 G17 G21
+N15 G54
+N20 M3 S12000
+N25 G0 X-3.1 Y-3.1
+N30 G0 Z5.
+N35 G1 Z-1.5 F300.
+N40 G1 X60. F1200.
+N45 Y2.4
+N50 X0.
+N55 Y4.8
+N60 X60.
+N65 Y7.2
+N70 X0.
+N75 Y9.6
+N80 X60.
+N85 Y12.
+N90 X0.
+N95 Y14.4
+N100 X60.
+N105 Y16.8
+N110 X0.
+N115 Y19.2
+N120 X60.
+N125 Y21.6
+N130 X0.
+N135 Y24.
+N140 X0.
+N145 Y26.4
+N150 X60.
+N155 Y28.8
+N160 X0.
+N165 Y31.2
+N170 X60.
+N175 Y33.6
+N180 X0.
+N185 Y36.
+N190 X60.
+N195 Y38.4
+N200 X0.
+N205 Y40.8
+N210 G0 Z5.
+N215 X0. Y0.
+N220 G1 Z-3. F300.
+N225 G1 X60. F1200.
+N230 Y2.4
+N235 X0.
+N240 Y4.8
+N245 X60.
+N250 Y7.2
+N255 X0.
+N260 Y9.6
+N265 X60.
+N270 Y12.
+N275 X0.
+N280 Y14.4
+N285 X60.
+N290 Y16.8
+N295 X0.
+N300 Y19.2
+N305 X60.
+N310 Y21.6
+N315 X0.
+N320 Y24.
+N325 X0.
+N330 Y26.4
+N335 X60.
+N340 Y28.8
+N345 X0.
+N350 Y31.2
+N355 X60.
+N360 Y33.6
+N365 X0.
+N370 Y36.
+N375 X60.
+N380 Y38.4
+N385 X0.
+N390 Y40.8
+N395 G0 Z5.
+N400 X0. Y0.
+N405 G1 Z-4.5 F300.
+N410 G1 X60. F1200.
+N415 Y2.4
+N420 X0.
+N425 Y4.8
+N430 X60.
+N435 Y7.2
+N440 X0.
+N445 Y9.6
+N450 X60.
+N455 Y12.
+N460 X0.
+N465 Y14.4
+N470 X60.
+N475 Y16.8
+N480 X0.
+N485 Y19.2
+N490 X60.
+N495 Y21.6
+N500 X0.
+N505 Y24.
+N510 X0.
+N515 Y26.4
+N520 X60.
+N525 Y28.8
+N530 X0.
+N535 Y31.2
+N540 X60.
+N545 Y33.6
+N550 X0.
+N555 Y36.
+N560 X60.
+N565 Y38.4
+N570 X0.
+N575 Y40.8
+N580 G0 Z5.
+N585 X0. Y0.
+N590 G1 Z-6. F300.
+N595 G1 X60. F1200.
+N600 Y2.4
+N605 X0.
+N610 Y4.8
+N615 X60.
+N620 Y7.2
+N625 X0.
+N630 Y9.6
+N635 X60.
+N640 Y12.
+N645 X0.
+N650 Y14.4
+N655 X60.
+N660 Y16.8
+N665 X0.
+N670 Y19.2
+N675 X60.
+N680 Y21.6
+N685 X0.
+N690 Y24.
+N695 X0.
+N700 Y26.4
+N705 X60.
+N710 Y28.8
+N715 X0.
+N720 Y31.2
+N725 X60.
+N730 Y33.6
+N735 X0.
+N740 Y36.
+N745 X60.
+N750 Y38.4
+N755 X0.
+N760 Y40.8
+N765 G0 Z5.
+N770 X0. Y0.
+(profile)
+G0 X-3. Y20.
+G1 Z-6. F300.
+G1 Y35. F900.
+G2 X5. Y43. I8. J0.
+G1 X55.
+G2 X63. Y35. I0. J-8.
+G1 Y5.
+G2 X55. Y-3. I-8. J0.
+G1 X5.
+G2 X-3. Y5. I0. J8.
+G1 Y20.
+G0 Z5.
+(parallel finishing, ball end mill)
+G0 X0. Y0.
+G1 Z-1. F600.
+G1 X2. Y0. Z-.6027 F2400.
+X4. Z-.2212
+X6. Z.1293
+X8. Z.4347
+X10. Z.6829
+X12. Z.8641
+X14. Z.9709
+X16. Z.9991
+X18. Z.9477
+X20. Z.8186
+X22. Z.617
+X24. Z.3509
+X26. Z.031
+X28. Z-.33
+X30. Z-.7178
+X32. Z-1.1167
+X34. Z-1.5111
+X36. Z-1.885
+X38. Z-2.2237
+X40. Z-2.5136
+X42. Z-2.7432
+X44. Z-2.9032
+X46. Z-2.9874
+X48. Z-2.9923
+X50. Z-2.9178
+X52. Z-2.7669
+X54. Z-2.5455
+X56. Z-2.2625
+X58. Z-1.9292
+G0 Z5.
+G0 X0. Y.8
+G1 Z-1. F600.
+G1 X2. Y.8 Z-.6077 F2400.
+X4. Z-.2311
+X6. Z.1149
+X8. Z.4164
+X10. Z.6614
+X12. Z.8403
+X14. Z.9457
+X16. Z.9736
+X18. Z.9228
+X20. Z.7954
+X22. Z.5963
+X24. Z.3337
+X26. Z.0178
+X28. Z-.3386
+X30. Z-.7214
+X32. Z-1.1153
+X34. Z-1.5046
+X36. Z-1.8737
+X38. Z-2.2081
+X40. Z-2.4943
+X42. Z-2.7209
+X44. Z-2.8789
+X46. Z-2.962
+X48. Z-2.9669
+X50. Z-2.8934
+X52. Z-2.7443
+X54. Z-2.5258
+X56. Z-2.2464
+X58. Z-1.9173
+G0 Z5.
+G0 X0. Y1.6
+G1 Z-1. F600.
+G1 X2. Y1.6 Z-.6228 F2400.
+X4. Z-.2607
+X6. Z.072
+X8. Z.3619
+X10. Z.5975
+X12. Z.7694
+X14. Z.8708
+X16. Z.8977
+X18. Z.8488
+X20. Z.7263
+X22. Z.5349
+X24. Z.2823
+X26. Z-.0213
+X28. Z-.364
+X30. Z-.7321
+X32. Z-1.1108
+X34. Z-1.4851
+X36. Z-1.8401
+X38. Z-2.1616
+X40. Z-2.4368
+X42. Z-2.6547
+X44. Z-2.8066
+X46. Z-2.8865
+X48. Z-2.8912
+X50. Z-2.8205
+X52. Z-2.6772
+X54. Z-2.4671
+X56. Z-2.1984
+X58. Z-1.882
+G0 Z5.
+G0 X0. Y2.4
+G1 Z-1. F600.
+G1 X2. Y2.4 Z-.6476 F2400.
+X4. Z-.3092
+X6. Z.0017
+X8. Z.2726
+X10. Z.4928
+X12. Z.6534
+X14. Z.7482
+X16. Z.7732
+X18. Z.7276
+X20. Z.6131
+X22. Z.4343
+X24. Z.1983
+X26. Z-.0855
+X28. Z-.4057
+X30. Z-.7497
+X32. Z-1.1036
+X34. Z-1.4533
+X36. Z-1.785
+X38. Z-2.0854
+X40. Z-2.3426
+X42. Z-2.5462
+X44. Z-2.6881
+X46. Z-2.7628
+X48. Z-2.7672
+X50. Z-2.7011
+X52. Z-2.5672
+X54. Z-2.3709
+X56. Z-2.1199
+X58. Z-1.8242
+G0 Z5.
+G0 X0. Y3.2
+G1 Z-1. F600.
+G1 X2. Y3.2 Z-.6813 F2400.
+X4. Z-.3753
+X6. Z-.0942
+X8. Z.1508
+X10. Z.3499
+X12. Z.4952
+X14. Z.5809
+X16. Z.6035
+X18. Z.5622
+X20. Z.4587
+X22. Z.297
+X24. Z.0836
+X26. Z-.173
+X28. Z-.4626
+X30. Z-.7736
+X32. Z-1.0936
+X34. Z-1.4099
+X36. Z-1.7099
+X38. Z-1.9815
+X40. Z-2.2141
+X42. Z-2.3982
+X44. Z-2.5266
+X46. Z-2.5941
+X48. Z-2.598
+X50. Z-2.5383
+X52. Z-2.4172
+X54. Z-2.2397
+X56. Z-2.0127
+X58. Z-1.7453
+G0 Z5.
+G0 X0. Y4.
+G1 Z-1. F600.
+G1 X2. Y4. Z-.7232 F2400.
+X4. Z-.4574
+X6. Z-.2132
+X8. Z-.0004
+X10. Z.1725
+X12. Z.2987
+X14. Z.3731
+X16. Z.3928
+X18. Z.357
+X20. Z.267
+X22. Z.1266
+X24. Z-.0588
+X26. Z-.2817
+X28. Z-.5332
+X30. Z-.8034
+X32. Z-1.0813
+X34. Z-1.3561
+X36. Z-1.6166
+X38. Z-1.8526
+X40. Z-2.0545
+X42. Z-2.2145
+X44. Z-2.326
+X46. Z-2.3846
+X48. Z-2.3881
+X50. Z-2.3362
+X52. Z-2.231
+X54. Z-2.0768
+X56. Z-1.8796
+X58. Z-1.6474
+G0 Z5.
+G0 X0. Y4.8
+G1 Z-1. F600.
+G1 X2. Y4.8 Z-.7721 F2400.
+X4. Z-.5533
+X6. Z-.3523
+X8. Z-.1772
+X10. Z-.0348
+X12. Z.0691
+X14. Z.1304
+X16. Z.1466
+X18. Z.117
+X20. Z.043
+X22. Z-.0726
+X24. Z-.2252
+X26. Z-.4087
+X28. Z-.6158
+X30. Z-.8381
+X32. Z-1.067
+X34. Z-1.2931
+X36. Z-1.5076
+X38. Z-1.7018
+X40. Z-1.8681
+X42. Z-1.9997
+X44. Z-2.0915
+X46. Z-2.1398
+X48. Z-2.1426
+X50. Z-2.0999
+X52. Z-2.0134
+X54. Z-1.8864
+X56. Z-1.7241
+X58. Z-1.5329
+G0 Z5.
+G0 X0. Y5.6
+G1 Z-1. F600.
+G1 X2. Y5.6 Z-.8269 F2400.
+X4. Z-.6607
+X6. Z-.508
+X8. Z-.3749
+X10. Z-.2668
+X12. Z-.1879
+X14. Z-.1413
+X16. Z-.129
+X18. Z-.1514
+X20. Z-.2077
+X22. Z-.2955
+X24. Z-.4114
+X26. Z-.5508
+X28. Z-.7081
+X30. Z-.877
+X32. Z-1.0509
+X34. Z-1.2227
+X36. Z-1.3856
+X38. Z-1.5332
+X40. Z-1.6595
+X42. Z-1.7595
+X44. Z-1.8292
+X46. Z-1.8659
+X48. Z-1.868
+X50. Z-1.8356
+X52. Z-1.7698
+X54. Z-1.6734
+X56. Z-1.5501
+X58. Z-1.4048
+G0 Z5.
+G0 X0. Y6.4
+G1 Z-1. F600.
+G1 X2. Y6.4 Z-.8861 F2400.
+X4. Z-.7767
+X6. Z-.6762
+X8. Z-.5886
+X10. Z-.5175
+X12. Z-.4655
+X14. Z-.4349
+X16. Z-.4268
+X18. Z-.4416
+X20. Z-.4786
+X22. Z-.5364
+X24. Z-.6127
+X26. Z-.7044
+X28. Z-.8079
+X30. Z-.9191
+X32. Z-1.0335
+X34. Z-1.1465
+X36. Z-1.2538
+X38. Z-1.3509
+X40. Z-1.434
+X42. Z-1.4998
+X44. Z-1.5457
+X46. Z-1.5698
+X48. Z-1.5712
+X50. Z-1.5499
+X52. Z-1.5066
+X54. Z-1.4431
+X56. Z-1.362
+X58. Z-1.2664
+G0 Z5.
+G0 X0. Y7.2
+G1 Z-1. F600.
+G1 X2. Y7.2 Z-.9482 F2400.
+X4. Z-.8984
+X6. Z-.8527
+X8. Z-.8129
+X10. Z-.7805
+X12. Z-.7569
+X14. Z-.7429
+X16. Z-.7393
+X18. Z-.746
+X20. Z-.7628
+X22. Z-.7891
+X24. Z-.8238
+X26. Z-.8655
+X28. Z-.9126
+X30. Z-.9632
+X32. Z-1.0152
+X34. Z-1.0667
+X36. Z-1.1154
+X38. Z-1.1596
+X40. Z-1.1974
+X42. Z-1.2273
+X44. Z-1.2482
+X46. Z-1.2592
+X48. Z-1.2598
+X50. Z-1.2501
+X52. Z-1.2304
+X54. Z-1.2016
+X56. Z-1.1647
+X58. Z-1.1212
+G0 Z5.
+G0 X0. Y8.
+G1 Z-1. F600.
+G1 X2. Y8. Z-1.0116 F2400.
+X4. Z-1.0227
+X6. Z-1.033
+X8. Z-1.0419
+X10. Z-1.0491
+X12. Z-1.0544
+X14. Z-1.0575
+X16. Z-1.0584
+X18. Z-1.0569
+X20. Z-1.0531
+X22. Z-1.0472
+X24. Z-1.0394
+X26. Z-1.0301
+X28. Z-1.0196
+X30. Z-1.0082
+X32. Z-.9966
+X34. Z-.9851
+X36. Z-.9742
+X38. Z-.9643
+X40. Z-.9558
+X42. Z-.9491
+X44. Z-.9444
+X46. Z-.942
+X48. Z-.9418
+X50. Z-.944
+X52. Z-.9484
+X54. Z-.9549
+X56. Z-.9631
+X58. Z-.9729
+G0 Z5.
+G0 X0. Y8.8
+G1 Z-1. F600.
+G1 X2. Y8.8 Z-1.0747 F2400.
+X4. Z-1.1465
+X6. Z-1.2124
+X8. Z-1.2698
+X10. Z-1.3165
+X12. Z-1.3506
+X14. Z-1.3707
+X16. Z-1.376
+X18. Z-1.3663
+X20. Z-1.342
+X22. Z-1.3041
+X24. Z-1.2541
+X26. Z-1.1939
+X28. Z-1.126
+X30. Z-1.0531
+X32. Z-.978
+X34. Z-.9039
+X36. Z-.8335
+X38. Z-.7698
+X40. Z-.7153
+X42. Z-.6722
+X44. Z-.6421
+X46. Z-.6262
+X48. Z-.6253
+X50. Z-.6393
+X52. Z-.6677
+X54. Z-.7093
+X56. Z-.7625
+X58. Z-.8252
+G0 Z5.
+(engraving)
+g3 x40. y20. i-10. j0. f800 (seg 0)
+g3 x39.7815 y22.0791 i-9.7815 j-2.0791 f800 (seg 1)
+g3 x39.1355 y24.0674 i-9.1355 j-4.0674 f800 (seg 2)
+g3 x38.0902 y25.8779 i-8.0902 j-5.8779 f800 (seg 3)
+g3 x36.6913 y27.4314 i-6.6913 j-7.4314 f800 (seg 4)
+g3 x35. y28.6603 i-5. j-8.6603 f800 (seg 5)
+g3 x33.0902 y29.5106 i-3.0902 j-9.5106 f800 (seg 6)
+g3 x31.0453 y29.9452 i-1.0453 j-9.9452 f800 (seg 7)
+g3 x28.9547 y29.9452 i1.0453 j-9.9452 f800 (seg 8)
+g3 x26.9098 y29.5106 i3.0902 j-9.5106 f800 (seg 9)
+g3 x25. y28.6603 i5. j-8.6603 f800 (seg 10)
+g3 x23.3087 y27.4314 i6.6913 j-7.4314 f800 (seg 11)
+g3 x21.9098 y25.8779 i8.0902 j-5.8779 f800 (seg 12)
+g3 x20.8645 y24.0674 i9.1355 j-4.0674 f800 (seg 13)
+g3 x20.2185 y22.0791 i9.7815 j-2.0791 f800 (seg 14)
+g3 x20. y20. i10. j0. f800 (seg 15)
+g3 x20.2185 y17.9209 i9.7815 j2.0791 f800 (seg 16)
+g3 x20.8645 y15.9326 i9.1355 j4.0674 f800 (seg 17)
+g3 x21.9098 y14.1221 i8.0902 j5.8779 f800 (seg 18)
+g3 x23.3087 y12.5686 i6.6913 j7.4314 f800 (seg 19)
+g3 x25. y11.3397 i5. j8.6603 f800 (seg 20)
+g3 x26.9098 y10.4894 i3.0902 j9.5106 f800 (seg 21)
+g3 x28.9547 y10.0548 i1.0453 j9.9452 f800 (seg 22)
+g3 x31.0453 y10.0548 i-1.0453 j9.9452 f800 (seg 23)
+g3 x33.0902 y10.4894 i-3.0902 j9.5106 f800 (seg 24)
+g3 x35. y11.3397 i-5. j8.6603 f800 (seg 25)
+g3 x36.6913 y12.5686 i-6.6913 j7.4314 f800 (seg 26)
+g3 x38.0902 y14.1221 i-8.0902 j5.8779 f800 (seg 27)
+g3 x39.1355 y15.9326 i-9.1355 j4.0674 f800 (seg 28)
+g3 x39.7815 y17.9209 i-9.7815 j2.0791 f800 (seg 29)
+(drill grid, expanded)
+G0 X5. Y5.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X5. Y15.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X5. Y25.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X5. Y35.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X17.5 Y5.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X17.5 Y15.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X17.5 Y25.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X17.5 Y35.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X30. Y5.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X30. Y15.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X30. Y25.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X30. Y35.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X42.5 Y5.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X42.5 Y15.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X42.5 Y25.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X42.5 Y35.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X55. Y5.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X55. Y15.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X55. Y25.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 X55. Y35.
+G0 Z1.
+G1 Z-4. F150.
+G0 Z1.
+G0 Z25.
+M5
+M30
@@ -0,0 +1,161 @@
+/*
+  parser_bench.c - g-code word parsing micro-benchmark, host builds only
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Times splitting a corpus of g-code lines into words, the way protocol
+ * feeds them to the parser, against the old way of reading every word's value
+ * as a float with read_float(), twice (once for commands, once for
+ * parameters). Lines are cleaned up (comments and whitespace removed, upper
+ * cased) beforehand, that part is the same either way.
+ *
+ * Both are timed over the given number of passes through the corpus, in turns
+ * and the given number of times each, alternating which goes first. The best
+ * time of each is reported, the others being the same work with more noise.
+ * Many short repetitions give steadier figures than a few long ones on a busy
+ * host, hence the defaults of 10 passes, 300 times.
+ *
+ * Usage: parser_bench <corpus.nc> [passes] [repetitions] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+
+#include "gcode.h"
+#include "nuts_bolts.h"
+#include "protocol.h"
+
+#define MAX_LINES 4096
+
+system_t sys; // Normally defined in main.c, left out of the benchmark
+
+static char *lines[MAX_LINES];
+static unsigned line_count;
+
+/* Same clean up as protocol_process() */
+static char *clean_line(const char *raw) {
+  char *line = malloc(strlen(raw) + 1), *p = line;
+  bool iscomment = false;
+
+  for(; *raw && *raw != '\n' && *raw != '\r'; raw++) {
+    if(iscomment) iscomment = (*raw != ')');
+    else if(*raw == '(') iscomment = true;
+    else if(*raw > ' ') *p++ = (*raw >= 'a' && *raw <= 'z') ? *raw - 'a' + 'A' : *raw;
+  }
+  *p = 0;
+
+  return line;
+}
+
+static double now(void) {
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/* The parser as it was: two passes, read_float() on every word of each */
+static unsigned parse_floats(const char *line) {
+  uint8_t char_counter, pass;
+  unsigned words = 0;
+  float value;
+
+  for(pass = 0; pass < 2; pass++)
+    for(char_counter = 0; line[char_counter]; words++) {
+      char_counter++; // Letter
+      if(!read_float((char *)line, &char_counter, &value)) return 0;
+    }
+
+  return words / 2;
+}
+
+/* The parser as it is: one pass, integer codes, words split on arrival */
+static unsigned parse_words(const char *line) {
+  static gc_block_t block;
+
+  gc_block_start(&block);
+  for(; *line; line++) gc_block_feed(&block, *line);
+  if(gc_block_finish(&block)) return 0;
+
+  return block.count;
+}
+
+typedef struct {
+  const char *name;
+  unsigned (*parse)(const char *);
+  double best; // Shortest time taken for all passes so far
+  unsigned words; // Per pass
+} parser_t;
+
+static parser_t parsers[] = {
+  {"read_float, two passes", parse_floats},
+  {"words on arrival, one pass", parse_words}
+};
+#define PARSERS (sizeof(parsers) / sizeof(parsers[0]))
+
+/* Times one repetition of passes through the corpus */
+static void run(parser_t *parser, unsigned passes) {
+  unsigned pass, i, words = 0;
+  double start = now(), elapsed;
+
+  for(pass = 0; pass < passes; pass++)
+    for(i = 0; i < line_count; i++) words += parser->parse(lines[i]);
+  elapsed = now() - start;
+  if(!parser->best || elapsed < parser->best) parser->best = elapsed;
+  parser->words = words / passes;
+}
+
+static void report(parser_t *parser, unsigned passes) {
+  printf("%-28s %10.0f lines/s %8.1f ns/line %8.1f ns/word\n", parser->name,
+      line_count * passes / parser->best, parser->best * 1e9 / (line_count * passes),
+      parser->best * 1e9 / (parser->words * passes));
+}
+
+int main(int argc, char **argv) {
+  char raw[256];
+  unsigned passes = argc > 2 ? atoi(argv[2]) : 10;
+  unsigned repetitions = argc > 3 ? atoi(argv[3]) : 300, repetition, i, bad = 0;
+  FILE *corpus;
+
+  if(argc < 2 || !(corpus = fopen(argv[1], "r"))) {
+    fprintf(stderr, "Usage: %s <corpus.nc> [passes] [repetitions]\n", argv[0]);
+    return 1;
+  }
+  while(line_count < MAX_LINES && fgets(raw, sizeof(raw), corpus)) {
+    lines[line_count] = clean_line(raw);
+    if(*lines[line_count]) line_count++;
+  }
+  fclose(corpus);
+  for(i = 0; i < line_count; i++)
+    if(parse_floats(lines[i]) != parse_words(lines[i])) {
+      fprintf(stderr, "Parsers disagree on: %s\n", lines[i]);
+      bad++;
+    }
+  if(bad) return 1;
+
+  printf("%u lines, %u passes, best of %u\n", line_count, passes, repetitions);
+  for(repetition = 0; repetition < repetitions; repetition++)
+    for(i = 0; i < PARSERS; i++) // In turns, every other repetition backwards
+      run(&parsers[repetition % 2 ? PARSERS - 1 - i : i], passes);
+  for(i = 0; i < PARSERS; i++) report(&parsers[i], passes);
+  printf("Speed-up: %.2fx\n", parsers[0].best / parsers[1].best);
+
+  return 0;
+}
@@ -0,0 +1,126 @@
+/*
+  planner_bench.c - planner micro-benchmark, host builds only
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Feeds synthetic move streams straight into plan_buffer_line(), discarding
+ * the oldest block whenever the plan is full as if the stepper had just
+ * finished it, and reports the cost of planning each block: wall-clock time,
+ * planner kernel runs (reverse and forward pass) and trapezoid
+ * recalculations. Built once per BLOCK_BUFFER_SIZE, with PLANNER_TELEMETRY,
+ * see Makefile.i386.
+ *
+ * Usage: planner_bench-<size> [blocks per stream] */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "config.h"
+
+#include "nuts_bolts.h"
+#include "planner.h"
+#include "settings.h"
+
+#define FEED_RATE 1000.0 // mm/min, fast enough for junction speeds to matter
+
+system_t sys; // Normally defined in main.c, left out of the benchmark
+
+typedef struct {
+  float x, y, z;
+  uint32_t seed;
+} stream_t;
+
+// Same sequence on every run and every host, unlike rand()
+static float random_unit(stream_t *s) {
+  s->seed = s->seed * 1103515245UL + 12345UL;
+
+  return (float)((s->seed >> 8) & 0xFFFF) / 0xFFFF;
+}
+
+// Random walk of 0.05-0.5mm segments in any direction
+static void next_random(stream_t *s, uint32_t i) {
+  float length = 0.05 + 0.45 * random_unit(s), angle = 2 * M_PI * random_unit(s);
+
+  s->x += length * cos(angle);
+  s->y += length * sin(angle);
+  s->z += (random_unit(s) - 0.5) * 0.1;
+}
+
+// 10mm radius circles in 0.1mm chords, like arcs come out of motion_control
+static void next_circle(stream_t *s, uint32_t i) {
+  float angle = i * 0.01;
+
+  s->x = 10 * cos(angle);
+  s->y = 10 * sin(angle);
+}
+
+// 1mm legs with a right angle corner at each end
+static void next_zigzag(stream_t *s, uint32_t i) {
+  s->x += 0.7071;
+  s->y += (i & 1) ? 0.7071 : -0.7071;
+}
+
+// Straight line cut up in 0.5mm pieces, every junction at full speed
+static void next_collinear(stream_t *s, uint32_t i) {
+  s->x += 0.4;
+  s->y += 0.3;
+}
+
+static double now(void) {
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void run(const char *name, void (*next)(stream_t *, uint32_t), uint32_t blocks) {
+  stream_t s = {0.0, 0.0, 0.0, 1};
+  plan_telemetry_t telemetry;
+  uint32_t i;
+  double start;
+
+  plan_init();
+  plan_telemetry_fetch(&telemetry); // Clear
+  start = now();
+  for(i = 0; i < blocks; i++) {
+    next(&s, i);
+    if(plan_check_full_buffer()) plan_discard_current_block();
+    plan_buffer_line(s.x, s.y, s.z, FEED_RATE, false);
+  }
+  start = now() - start;
+  plan_telemetry_fetch(&telemetry);
+  printf("%-12s %8.1f ns/block %7.2f kernel runs/block (max %3u) %7.2f trapezoids/block (max %3u)\n",
+      name, start * 1e9 / blocks, (double)telemetry.kernel_visits / telemetry.blocks,
+      telemetry.max_kernel_visits, (double)telemetry.trapezoids / telemetry.blocks,
+      telemetry.max_trapezoids);
+}
+
+int main(int argc, char **argv) {
+  uint32_t blocks = argc > 1 ? atol(argv[1]) : 200000;
+
+  i386_set_log_level(0); // No HAL chatter, only the planner runs anyway
+  settings_reset();
+  printf("BLOCK_BUFFER_SIZE %u, %lu blocks per stream\n", BLOCK_BUFFER_SIZE, (unsigned long)blocks);
+  run("random", next_random, blocks);
+  run("circles", next_circle, blocks);
+  run("zig-zag", next_zigzag, blocks);
+  run("collinear", next_collinear, blocks);
+
+  return 0;
+}
@@ -0,0 +1,270 @@
+/*
+  binary_protocol.c - compact framed binary command protocol
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "config.h"
+
+#include "binary_protocol.h"
+
+#include "coolant_control.h"
+#include "gcode.h"
+#include "motion_control.h"
+#include "nuts_bolts.h"
+#include "protocol.h"
+#include "settings.h"
+#include "spindle_control.h"
+
+
+#ifdef BINARY_PROTOCOL
+
+// Offsets within a frame
+#define BP_FRAME_LEN 1
+#define BP_FRAME_SEQ 2
+#define BP_FRAME_CMD 3
+#define BP_FRAME_PAYLOAD 4
+#define BP_FRAME_OVERHEAD 6 // SYNC, LEN, SEQ, CMD and CRC16
+#define BP_REALTIME_FRAME (BP_FRAME_OVERHEAD + 1) // Length of a BP_CMD_REALTIME frame
+
+static uint8_t frame[BP_MAX_PAYLOAD + BP_FRAME_OVERHEAD]; // Frame being received
+static uint16_t frame_index; // Bytes of the frame received so far, 0 if none
+static bool executed; // Whether a frame was executed since bp_init()
+static uint8_t last_seq; // Sequence number of the frame executed last, 0xFF if none
+static bool discard; // Throwing bytes away until the next SYNC, after a bad frame
+static bool resync; // Dropping frames until the one after last_seq, after a bad frame
+static uint8_t last_status; // Status it was acknowledged with
+static float feed_rate; // Modal feed rate of BP_CMD_LINE and BP_CMD_ARC, in mm/min
+
+// Real-time command filter state, only ever touched by bp_filter() and bp_init()
+static bool filter_binary; // SYNC seen since bp_init(), single bytes are no real-time commands
+static uint8_t filter_window[BP_REALTIME_FRAME]; // The bytes received last, oldest first
+
+void bp_init() {
+  frame_index = 0;
+  executed = false;
+  last_seq = 0xFF; // So that the first frame, SEQ 0, follows it
+  discard = resync = false;
+  feed_rate = DEFAULT_FEED;
+  host_cli(); // bp_filter() may run at interrupt level
+  filter_binary = false;
+  memset(filter_window, 0, sizeof(filter_window));
+  host_sei();
+}
+
+bool bp_busy() {
+  return frame_index || discard;
+}
+
+// Not knowing where frames start and end, after a bad one in particular, this only looks at the
+// last BP_REALTIME_FRAME bytes received and takes them for a real-time command if they make up a
+// BP_CMD_REALTIME frame with a good CRC.
+bool bp_filter(uint8_t c, char *command) {
+  uint16_t crc = 0xFFFF;
+  uint8_t i;
+
+  if(c == BP_SYNC) filter_binary = true;
+  if(!filter_binary) return false;
+  memmove(filter_window, filter_window + 1, BP_REALTIME_FRAME - 1);
+  filter_window[BP_REALTIME_FRAME - 1] = c;
+  *command = 0;
+  if(filter_window[0] != BP_SYNC || filter_window[BP_FRAME_LEN] != 1 ||
+      filter_window[BP_FRAME_CMD] != BP_CMD_REALTIME)
+    return true;
+  for(i = BP_FRAME_LEN; i <= BP_FRAME_PAYLOAD; i++) crc = host_crc16(crc, filter_window[i]);
+  if((crc & 0xFF) == filter_window[i] && (crc >> 8) == filter_window[i + 1])
+    *command = filter_window[BP_FRAME_PAYLOAD];
+
+  return true;
+}
+
+bool bp_process(uint8_t c) {
+  if(discard) {
+    if(c != BP_SYNC) return false;
+    discard = false;
+  }
+  frame[frame_index++] = c;
+  if(frame_index <= BP_FRAME_LEN) return false;
+  // A LEN this large can only be garbage, no point in waiting for the rest
+  if(frame[BP_FRAME_LEN] > BP_MAX_PAYLOAD) return true;
+
+  return frame_index == frame[BP_FRAME_LEN] + BP_FRAME_OVERHEAD;
+}
+
+// Fetches the next little-endian float from the frame payload
+static float fetch_float(uint8_t **p) {
+  float value;
+
+  memcpy(&value, *p, sizeof(value));
+  *p += sizeof(value);
+
+  return value;
+}
+
+// Counts the axis and feed rate flags set in flags
+static uint8_t count_words(uint8_t flags) {
+  uint8_t i, words = 0;
+
+  for(i = 0; i < 4; i++) if(bit_istrue(flags, bit(i))) words++;
+
+  return words;
+}
+
+// Reads the target of a BP_CMD_LINE or BP_CMD_ARC, missing axes stay where they are
+static void fetch_target(uint8_t flags, uint8_t **p, float *target) {
+  uint8_t i;
+
+  gc_get_position(target);
+  for(i = 0; i < 3; i++) if(bit_istrue(flags, bit(i))) target[i] = fetch_float(p);
+}
+
+// Works out the feed rate of a move, returns false if an inverse time move has no F
+static bool fetch_feed_rate(uint8_t flags, uint8_t **p, float *rate) {
+  if(bit_istrue(flags, BP_FLAG_F)) {
+    *rate = fetch_float(p);
+    if(!bit_istrue(flags, BP_FLAG_INVERSE)) feed_rate = *rate;
+  } else if(bit_istrue(flags, BP_FLAG_INVERSE)) return false;
+  else *rate = feed_rate;
+
+  return true;
+}
+
+static uint8_t execute_line(uint8_t length, uint8_t *p) {
+  uint8_t flags = *p++;
+  float target[3], rate;
+
+  if(length != 1 + 4 * count_words(flags)) return STATUS_BAD_FRAME;
+  fetch_target(flags, &p, target);
+  if(!fetch_feed_rate(flags, &p, &rate)) return STATUS_INVALID_COMMAND;
+  if(bit_istrue(flags, BP_FLAG_RAPID))
+    mc_line(target[X_AXIS], target[Y_AXIS], target[Z_AXIS], settings.default_seek_rate, false);
+  else mc_line(target[X_AXIS], target[Y_AXIS], target[Z_AXIS], rate,
+      bit_istrue(flags, BP_FLAG_INVERSE));
+  gc_set_position(target);
+
+  return STATUS_OK;
+}
+
+static uint8_t execute_arc(uint8_t length, uint8_t *p) {
+  uint8_t flags = *p++, axis_0, axis_1, axis_linear;
+  float position[3], target[3], offset[3] = {0.0, 0.0, 0.0}, rate;
+
+  if(length != 1 + 4 * (count_words(flags) + 2)) return STATUS_BAD_FRAME;
+  switch(flags & (BP_FLAG_PLANE_XZ | BP_FLAG_PLANE_YZ)) {
+    case BP_FLAG_PLANE_XY: axis_0 = X_AXIS; axis_1 = Y_AXIS; axis_linear = Z_AXIS; break;
+    case BP_FLAG_PLANE_XZ: axis_0 = X_AXIS; axis_1 = Z_AXIS; axis_linear = Y_AXIS; break;
+    case BP_FLAG_PLANE_YZ: axis_0 = Y_AXIS; axis_1 = Z_AXIS; axis_linear = X_AXIS; break;
+    default: return STATUS_BAD_FRAME;
+  }
+  gc_get_position(position);
+  fetch_target(flags, &p, target);
+  offset[axis_0] = fetch_float(&p);
+  offset[axis_1] = fetch_float(&p);
+  if(!fetch_feed_rate(flags, &p, &rate)) return STATUS_INVALID_COMMAND;
+  mc_arc(position, target, offset, axis_0, axis_1, axis_linear, rate,
+      bit_istrue(flags, BP_FLAG_INVERSE), hypot(offset[axis_0], offset[axis_1]),
+      bit_istrue(flags, BP_FLAG_CW));
+  gc_set_position(target);
+
+  return STATUS_OK;
+}
+
+static uint8_t execute_command(uint8_t command, uint8_t length, uint8_t *p) {
+  uint8_t parameter;
+  float value;
+
+  switch(command) {
+    case BP_CMD_LINE: return execute_line(length, p);
+    case BP_CMD_ARC: return execute_arc(length, p);
+    case BP_CMD_DWELL:
+      if(length != 4) return STATUS_BAD_FRAME;
+      value = fetch_float(&p);
+      if(value < 0) return STATUS_INVALID_COMMAND;
+      mc_dwell(value);
+      return STATUS_OK;
+    case BP_CMD_SETTING:
+      if(length != 5) return STATUS_BAD_FRAME;
+      parameter = *p++;
+      settings_store_setting(parameter, fetch_float(&p));
+      return STATUS_OK;
+    case BP_CMD_IO:
+      if(length != 2) return STATUS_BAD_FRAME;
+      switch(p[0]) {
+        case BP_IO_SPINDLE:
+          if((int8_t)p[1] < SPINDLE_CCW || (int8_t)p[1] > SPINDLE_CW) return STATUS_INVALID_COMMAND;
+          gc_set_spindle_direction((int8_t)p[1]);
+          return STATUS_OK;
+        case BP_IO_COOLANT:
+          if(p[1] & ~(COOLANT_FLOOD | COOLANT_MIST)) return STATUS_INVALID_COMMAND;
+          gc_set_coolant_state(p[1]);
+          return STATUS_OK;
+        default: return STATUS_UNSUPPORTED_STATEMENT;
+      }
+    default: return STATUS_UNSUPPORTED_STATEMENT;
+  }
+}
+
+// Starts over at the next SYNC, with the sender resending everything after last_seq
+static uint8_t bad_frame(void) {
+  discard = resync = true;
+
+  return STATUS_BAD_FRAME;
+}
+
+uint8_t bp_execute() {
+  uint8_t length = frame[BP_FRAME_LEN], i;
+  uint16_t crc = 0xFFFF;
+
+  if(length > BP_MAX_PAYLOAD) return bad_frame();
+  for(i = BP_FRAME_LEN; i < BP_FRAME_PAYLOAD + length; i++) crc = host_crc16(crc, frame[i]);
+  if((crc & 0xFF) != frame[i] || (crc >> 8) != frame[i + 1]) return bad_frame();
+  // Already carried out by bp_filter(), out of sequence
+  if(frame[BP_FRAME_CMD] == BP_CMD_REALTIME) return BP_STATUS_DROPPED;
+  // A retry of the frame we executed last, its acknowledgement must have gone missing
+  if(executed && frame[BP_FRAME_SEQ] == last_seq) return last_status;
+  // Frames that were in flight behind a bad one, the sender will resend them
+  if(resync) {
+    if(frame[BP_FRAME_SEQ] != (uint8_t)(last_seq + 1)) return BP_STATUS_DROPPED;
+    resync = false;
+  }
+
+  last_status = execute_command(frame[BP_FRAME_CMD], length, &frame[BP_FRAME_PAYLOAD]);
+  last_seq = frame[BP_FRAME_SEQ];
+  executed = true;
+
+  return last_status;
+}
+
+void bp_acknowledge(uint8_t status) {
+  // A bad frame's own SEQ may be garbage, tell the sender where to resume instead
+  uint8_t ack[] = {BP_SYNC, 1, discard ? last_seq : frame[BP_FRAME_SEQ], BP_CMD_ACK, status}, i;
+  uint16_t crc = 0xFFFF;
+
+  frame_index = 0;
+  if(status == BP_STATUS_DROPPED) return;
+  for(i = 0; i < sizeof(ack); i++) {
+    if(i >= BP_FRAME_LEN) crc = host_crc16(crc, ack[i]);
+    host_serialconsole_write(ack[i], true);
+  }
+  host_serialconsole_write(crc & 0xFF, true);
+  host_serialconsole_write(crc >> 8, true);
+}
+
+#endif
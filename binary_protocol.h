@@ -0,0 +1,109 @@
+/*
+  binary_protocol.h - compact framed binary command protocol
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Frame layout, all multi-byte quantities little-endian, floats IEEE754 single
+ * precision:
+ *
+ *   SYNC LEN SEQ CMD PAYLOAD[LEN] CRC16
+ *
+ * SYNC is BP_SYNC, which is above 0x7F and therefore never occurs in g-code.
+ * CRC16 is host_crc16() over LEN, SEQ, CMD and PAYLOAD, starting at 0xFFFF.
+ * Every frame is answered with a BP_CMD_ACK frame carrying the same SEQ and a
+ * single payload byte: the STATUS_* code of executing it (or STATUS_BAD_FRAME).
+ * A frame repeating the previous SEQ is acknowledged again but not executed,
+ * so that the sender may safely retry when an ack goes missing.
+ *
+ * A frame failing its CRC check, or with a LEN above BP_MAX_PAYLOAD, is
+ * answered with STATUS_BAD_FRAME and the SEQ of the last good frame (0xFF if
+ * there was none yet): its own SEQ can't be trusted. Everything up to the
+ * next SYNC is then thrown away, and so are, unacknowledged, all frames
+ * until the one following the last good one arrives: the sender is expected
+ * to resend everything after the SEQ it was given.
+ *
+ * Frames may hold any byte, so once grbl has seen a SYNC it no longer takes
+ * single received bytes for real-time commands ('?', '!', '~', ^X) until the
+ * next reset. They are then sent as BP_CMD_REALTIME frames instead, which are
+ * recognized by their CRC at interrupt level, whatever state the decoder is
+ * in. These are not acknowledged and their SEQ is ignored, they may be sent
+ * in between any two frames.
+ * See script/binary_stream.py for a reference encoder. */
+
+#ifndef binary_protocol_h
+#define binary_protocol_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BP_SYNC 0xA5
+#define BP_MAX_PAYLOAD 30
+
+// Commands and their payloads
+#define BP_CMD_LINE 0x01    // flags, [X], [Y], [Z], [F]: BP_FLAG_* say which floats follow
+#define BP_CMD_ARC 0x02     // flags, [X], [Y], [Z], offset 0, offset 1, [F]: in the BP_FLAG_PLANE_* plane
+#define BP_CMD_DWELL 0x03   // seconds
+#define BP_CMD_SETTING 0x04 // uint8 parameter, value: same as '$parameter=value'
+#define BP_CMD_IO 0x05      // uint8 BP_IO_*, int8 value
+#define BP_CMD_REALTIME 0x06 // char: the real-time command, e.g. CMD_FEED_HOLD
+#define BP_CMD_ACK 0x80     // uint8 status, sent by grbl only
+
+// Returned by bp_execute() for frames dropped while resynchronizing, bp_acknowledge() then sends
+// nothing. Not a STATUS_* code, those are never sent as such.
+#define BP_STATUS_DROPPED 0xFF
+
+// Flags byte of BP_CMD_LINE and BP_CMD_ARC. Targets are absolute machine coordinates in mm, feed
+// rates in mm/min; F is modal across frames.
+#define BP_FLAG_X bit(0)
+#define BP_FLAG_Y bit(1)
+#define BP_FLAG_Z bit(2)
+#define BP_FLAG_F bit(3)
+#define BP_FLAG_RAPID bit(4)      // Line only: move at the default seek rate
+#define BP_FLAG_INVERSE bit(5)    // F is an inverse time feed rate for this move
+#define BP_FLAG_CW bit(4)         // Arc only: clockwise
+#define BP_FLAG_PLANE_XY 0x00     // Arc only: plane selection, two bits
+#define BP_FLAG_PLANE_XZ bit(6)
+#define BP_FLAG_PLANE_YZ bit(7)
+
+// BP_CMD_IO devices
+#define BP_IO_SPINDLE 0x00 // value: 1 = CW, -1 = CCW, 0 = stop
+#define BP_IO_COOLANT 0x01 // value: COOLANT_* mode
+
+// Initialize the binary protocol decoder
+void bp_init();
+
+// Returns true while a frame is being received, or bytes thrown away after a bad one. Bytes must
+// then go to bp_process().
+bool bp_busy();
+
+// Feeds one received byte to the decoder. Returns true once a whole frame has been received, which
+// must then be passed to bp_execute() and bp_acknowledge() before feeding the next byte.
+bool bp_process(uint8_t c);
+
+// Executes the frame just received, returns its STATUS_* code or BP_STATUS_DROPPED. Frames
+// failing their CRC check are not executed, neither are retries of the frame executed last nor
+// frames out of sequence after a bad one.
+uint8_t bp_execute();
+
+// Sends the acknowledgement of the frame just received and executed
+void bp_acknowledge(uint8_t status);
+
+// Called by the real-time command filter for every received byte. Returns false until the first
+// SYNC, the byte may then be a real-time command itself. Afterwards returns true and sets command
+// to the real-time command of the BP_CMD_REALTIME frame c completes, 0 if none.
+bool bp_filter(uint8_t c, char *command);
+
+#endif
@@ -65,8 +65,17 @@
 #define LIMIT_Z_POS_TYPE LIMIT_TYPE_HARD
 #define LIMIT_Z_POS_VALUE 110.0
 
-// The number of linear motions that can be in the plan at any given time
-#define BLOCK_BUFFER_SIZE 20
+// The number of linear motions that can be in the plan at any given time. Can be overridden on the
+// compiler command line (e.g. -DBLOCK_BUFFER_SIZE=16), like the planner benchmark does.
+#ifndef BLOCK_BUFFER_SIZE
+  #define BLOCK_BUFFER_SIZE 20
+#endif
+
+// The number of parsed motions held back while the plan is full, so that grbl
+// keeps reading and parsing the next lines instead of waiting for room in the
+// plan. Each one has room for an arc's generator state and costs 70 bytes of
+// RAM, must be 1 to 255.
+#define MOTION_QUEUE_SIZE 4
 
 // Specifies the number of work coordinate systems grbl will support (G54-G59).
 // This parameter must be 1 or greater, currently supporting up to a value of 6.
@@ -123,6 +132,10 @@
 // computational efficiency of generating arcs.
 #define N_ARC_CORRECTION 25 // Integer (1-255)
 
+// Distance the drill backs off after each peck of a G73 chip breaking cycle and stops short of the
+// bottom of the hole when coming back down during a G83 peck drilling cycle.
+#define DRILL_PECK_CLEARANCE 0.25 // (mm)
+
 // Time delay increments performed during a dwell. The default value is set at 50ms, which provides
 // a maximum time delay of roughly 55 minutes, more than enough for most any application. Increasing
 // this delay will increase the maximum dwell time linearly, but also reduces the responsiveness of 
@@ -130,6 +143,15 @@
 // time step. Also, keep in mind that the Arduino delay timer is not very accurate for long delays.
 #define DWELL_TIME_STEP 50 // Integer (1-255) (milliseconds)
 
+// Define runtime command special characters. These characters are 'picked-off' directly from the
+// serial read data stream and are not passed to the grbl line execution parser. Select characters
+// that do not and must not exist in the streamed g-code program. ASCII control characters may be 
+// used, if they are available per user setup.
+#define CMD_STATUS_REPORT '?'
+#define CMD_FEED_HOLD '!'
+#define CMD_CYCLE_START '~'
+#define CMD_RESET 0x18 // ctrl-x
+
 // ---------------------------------------------------------------------------------------
 // FOR ADVANCED USERS ONLY: 
 
@@ -149,6 +171,38 @@
 // total delay added with the Grbl settings pulse microseconds must not exceed 127 ms.
 #define STEP_PULSE_DELAY 10 // Step pulse delay in microseconds. Default disabled.
 
+// Instruments the stepper driver interrupt: min/avg/max run time in CPU cycles, a coarse histogram
+// of it, the shortest step period seen, how many times the interrupt found itself still busy and
+// how many times the next compare match arrived before it was done (late). Stream a representative
+// program (script/isr_timing.nc is a good start) and send '$I' to read and clear the figures. The
+// reported headroom must stay comfortably positive at the highest feed rates you intend to run.
+// The measurement itself costs some cycles per step, so leave this disabled in production builds.
+// NOTE: On host builds the figures are derived from wall-clock time and only good for comparisons.
+// #define STEPPER_ISR_TIMING
+
+// Keeps planner and buffer statistics to help tell whether stutter comes from the serial link, the
+// parser or the planner: buffer underruns (the stepper finding the buffer empty in motion, other
+// than when draining it on purpose, e.g. for a dwell or program end), time spent in motion with
+// at most one block queued, a coarse buffer occupancy histogram sampled while in motion and the
+// cost of replanning each new block, in planner kernel runs and trapezoid recalculations. Send '$P'
+// to read and clear the figures.
+// NOTE: A program simply running out of lines without an M2/M30 counts as one underrun.
+// #define PLANNER_TELEMETRY
+
+// Accepts compact binary frames (see binary_protocol.h) in addition to g-code lines, for hosts that
+// do their own g-code parsing. A straight move costs 11 to 23 bytes on the wire, floats go across
+// as they are and the line parser is skipped entirely. Frames are checksummed, sequenced and
+// acknowledged with a binary ack frame instead of 'ok'. script/binary_stream.py shows how.
+// NOTE: Frames start with a byte above 0x7F, g-code sent alongside must be plain 7-bit ASCII.
+// #define BINARY_PROTOCOL
+
+// Appends the free space left in the serial receive buffer, in bytes, to every 'ok' (e.g. 'ok:98').
+// Since 'ok' goes out before grbl reads anything of the next line, a streaming program counting
+// characters can check its count against it and get back in step should the two ever disagree,
+// instead of overflowing the buffer (script/stream.py does when the count is there). Mind that
+// terminal programs and streamers looking for an 'ok' line alone will not understand it.
+// #define REPORT_RX_FREE
+
 // ---------------------------------------------------------------------------------------
 
 // TODO: The following options are set as compile-time options for now, until the next EEPROM 
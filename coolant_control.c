@@ -24,7 +24,7 @@
 
 #include "coolant_control.h"
 
-#include "planner.h"
+#include "motion_control.h"
 
 
 static uint8_t current_coolant_mode;
@@ -43,7 +43,7 @@ void coolant_init(void) {
 void coolant_stop(void) {
   /* If coolant was running, we need to wait until all previous moves are
    * executed before turning it off. */
-  if(current_coolant_mode) plan_synchronize();
+  if(current_coolant_mode) mc_synchronize();
 
   #ifdef CSPRAY_ENABLE
     host_gpio_write(CSPRAY_ENABLE, false, HOST_GPIO_MODE_BIT);
@@ -58,7 +58,7 @@ void coolant_run(uint8_t mode) {
   /* If we need to change state, we must wait for all moves to complete before
    * doing so. */
   if(mode != current_coolant_mode) {
-    plan_synchronize();
+    mc_synchronize();
     if(mode != COOLANT_OFF) {
       #ifdef CSPRAY_ENABLE
         if(mode & COOLANT_MIST)
@@ -29,6 +29,8 @@
 
 #include "config.h"
 
+#include "gcode.h"
+
 #include "coolant_control.h"
 #include "motion_control.h"
 #include "nuts_bolts.h"
@@ -45,7 +47,7 @@
 // and are similar/identical to other g-code interpreters by manufacturers (Haas,Fanuc,Mazak,etc).
 #define MODAL_GROUP_NONE 0
 #define MODAL_GROUP_0 1 // [G4,G10,G28,G30,G53,G92,G92.1] Non-modal
-#define MODAL_GROUP_1 2 // [G0,G1,G2,G3,G80] Motion
+#define MODAL_GROUP_1 2 // [G0,G1,G2,G3,G73,G80,G81,G82,G83] Motion
 #define MODAL_GROUP_2 3 // [G17,G18,G19] Plane selection
 #define MODAL_GROUP_3 4 // [G90,G91] Distance mode
 #define MODAL_GROUP_4 5 // [M0,M1,M2,M30] Stopping
@@ -53,6 +55,7 @@
 #define MODAL_GROUP_6 7 // [G20,G21] Units
 #define MODAL_GROUP_7 8 // [M3,M4,M5] Spindle turning
 #define MODAL_GROUP_12 9 // [G54,G55,G56,G57,G58,G59] Coordinate system selection
+#define MODAL_GROUP_10 10 // [G98,G99] Canned cycle return mode
 
 // Define command actions for within execution-type modal groups (motion, stopping, non-modal). Used
 // internally by the parser to know which command to execute.
@@ -61,10 +64,17 @@
 #define MOTION_MODE_CW_ARC 2  // G2
 #define MOTION_MODE_CCW_ARC 3  // G3
 #define MOTION_MODE_CANCEL 4 // G80
+#define MOTION_MODE_DRILL 5 // G81
+#define MOTION_MODE_DRILL_DWELL 6 // G82
+#define MOTION_MODE_DRILL_PECK 7 // G83
+#define MOTION_MODE_DRILL_CHIP_BREAK 8 // G73
+
+#define motion_mode_is_cycle(mode) ((mode) >= MOTION_MODE_DRILL)
 
 #define PROGRAM_FLOW_RUNNING 0
-#define PROGRAM_FLOW_PAUSED 1 // M0, M1
+#define PROGRAM_FLOW_PAUSED 1 // M0
 #define PROGRAM_FLOW_COMPLETED 2 // M2, M30
+#define PROGRAM_FLOW_OPTIONAL_PAUSE 3 // M1, left to the optional stop switch when it gets there
 
 #define NON_MODAL_NONE 0
 #define NON_MODAL_DWELL 1 // G4
@@ -73,14 +83,21 @@
 #define NON_MODAL_SET_COORDINATE_OFFSET 4 // G92
 #define NON_MODAL_RESET_COORDINATE_OFFSET 5 //G92.1
 
+#define WORD_F bit(0) // Feed rate given in block
+#define WORD_P bit(1)
+#define WORD_Q bit(2)
+#define WORD_R bit(3)
+#define WORD_DEPTH bit(4) // Canned cycles only: hole bottom known, from the drill axis word
+
 typedef struct {
   uint8_t status_code;              // Parser status for current block
-  uint8_t motion_mode;              // {G0, G1, G2, G3, G80}
+  uint8_t motion_mode;              // {G0, G1, G2, G3, G73, G80, G81, G82, G83}
   uint8_t inverse_feed_rate_mode:1; // {G93, G94}
   uint8_t inches_mode:1;            // 0 = millimeter mode, 1 = inches mode {G20, G21}
   uint8_t absolute_mode:1;          // 0 = relative motion, 1 = absolute motion {G90, G91}
   uint8_t coolant_state:2;          // 00 = all coolant off, 01 = flood on, 10 = mist on, 11 = both on
-  uint8_t reserved:3;               // Make sure GCC doesn't get any ideas with remaining bits
+  uint8_t retract_to_r:1;           // 0 = canned cycles return to initial level, 1 = to R level {G98, G99}
+  uint8_t reserved:2;               // Make sure GCC doesn't get any ideas with remaining bits
   uint8_t program_flow;             // {M0, M1, M2, M30}
   int8_t spindle_direction;         // 1 = running CW, -1 = running CCW, 0 = Stopped {M3, M4, M5}
   float feed_rate;                  // Millimeters/second
@@ -88,13 +105,14 @@ typedef struct {
   uint8_t plane_axis_0, 
           plane_axis_1, 
           plane_axis_2;             // The axes of the selected plane
+  uint8_t cycle_words;              // Canned cycle parameters known so far {WORD_P, WORD_Q, WORD_R, WORD_DEPTH}
+  float cycle_p, cycle_q, cycle_r,
+        cycle_depth;                // Canned cycle parameters, they stick until the cycle is cancelled
 } parser_state_t;
 static parser_state_t gc;
 
 #define FAIL(status) gc.status_code = status;
 
-static bool next_statement(char *letter, float *float_ptr, char *line, uint8_t *char_counter);
-
 static void select_plane(uint8_t axis_0, uint8_t axis_1, uint8_t axis_2) 
 {
   gc.plane_axis_0 = axis_0;
@@ -117,22 +135,82 @@ void gc_set_current_position(int32_t x, int32_t y, int32_t z) {
   gc.position[Z_AXIS] = z / settings.steps_per_mm[Z_AXIS];
 }
 
+void gc_get_position(float *position) {
+  memcpy(position, gc.position, sizeof(gc.position));
+}
+
+void gc_set_position(float *position) {
+  memcpy(gc.position, position, sizeof(gc.position));
+}
+
+void gc_set_spindle_direction(int8_t direction) {
+  gc.spindle_direction = direction;
+  spindle_run(gc.spindle_direction);
+}
+
+void gc_set_coolant_state(uint8_t mode) {
+  gc.coolant_state = mode;
+  coolant_run(gc.coolant_state);
+}
+
 static float to_millimeters(float value) {
   return (gc.inches_mode ? (value * MM_PER_INCH) : value);
 }
 
-// Executes one line of 0-terminated G-Code. The line is assumed to contain only uppercase
-// characters and signed floating point values (no whitespace). Comments and block delete
-// characters have been removed. All units and positions are converted and exported to grbl's
-// internal functions in terms of (mm, mm/min) and absolute machine coordinates, respectively.
-uint8_t gc_execute_line(char *line) {
-  uint8_t char_counter = 0;  
+void gc_block_start(gc_block_t *block) {
+  block->count = 0;
+  block->status = STATUS_OK;
+  block->inword = false;
+}
+
+// Completes the word being read, if any
+static void block_finish_word(gc_block_t *block) {
+  gc_word_t *word = &block->words[block->count];
+  bool valid;
+
+  if(!block->inword) return;
+  block->inword = false;
+  if(gc_is_code_word(word->letter)) valid = number_finish_code(&block->reader, &word->number.code);
+  else valid = number_finish(&block->reader, &word->number.value);
+  if(valid) block->count++;
+  else block->status = STATUS_BAD_NUMBER_FORMAT;
+}
+
+// There is no limit to the length of a line, only to the number of words in a block
+uint8_t gc_block_feed(gc_block_t *block, char c) {
+  if(block->status) return block->status; // Already failed, nothing more to learn from this block
+  if(block->inword && number_feed(&block->reader, c)) return STATUS_OK;
+  block_finish_word(block);
+  if(block->status) return block->status;
+  if((c < 'A') || (c > 'Z')) block->status = STATUS_EXPECTED_COMMAND_LETTER;
+  else if(block->count == GC_BLOCK_WORDS) block->status = STATUS_OVERFLOW;
+  else {
+    block->words[block->count].letter = c;
+    number_start(&block->reader);
+    block->inword = true;
+  }
+
+  return block->status;
+}
+
+uint8_t gc_block_finish(gc_block_t *block) {
+  if(!block->status) block_finish_word(block);
+
+  return block->status;
+}
+
+// Executes one block of G-Code, split into words as it was received. All units and positions
+// are converted and exported to grbl's internal functions in terms of (mm, mm/min) and absolute
+// machine coordinates, respectively.
+uint8_t gc_execute_block(gc_block_t *block) {
+  uint8_t word, axis;
   char letter;
-  float value;
-  int int_value;
+  float value = 0; // Value of a parameter word
+  int int_value = 0; // Value of a code word
   
   uint16_t modal_group_words = 0;  // Bitflag variable to track and check modal group words in block
   uint8_t axis_words = 0;          // Bitflag to track which XYZ(ABC) parameters exist in block
+  uint8_t parameter_words = 0;     // Bitflag to track which other parameters exist in block
 
   float inverse_feed_rate = -1; // negative inverse_feed_rate means no inverse_feed_rate specified
   uint8_t absolute_override = false; // true(1) = absolute motion for this block only {G53}
@@ -141,25 +219,32 @@ uint8_t gc_execute_line(char *line) {
   float target[3], offset[3];  
   clear_vector(target); // XYZ(ABC) axes parameters.
   clear_vector(offset); // IJK Arc offsets are incremental. Value of zero indicates no change.
+  float f = 0, p = 0, q = 0, r = 0;
+  uint8_t l = 0;
     
   gc.status_code = STATUS_OK;
   
-  /* Pass 1: Commands and set all modes. Check for modal group violations.
+  /* Single pass over the words of the block: commands set all modes and are checked for modal
+     group violations, parameters are stored as read for conversion once all modes are known.
      NOTE: Modal group numbers are defined in Table 4 of NIST RS274-NGC v3, pg.20 */
   uint8_t group_number = MODAL_GROUP_NONE;
-  while(next_statement(&letter, &value, line, &char_counter)) {
-    int_value = trunc(value);
+  for(word = 0; word < block->count; word++) {
+    letter = block->words[word].letter;
+    if(gc_is_code_word(letter)) int_value = block->words[word].number.code / 10;
+    else value = block->words[word].number.value;
     switch(letter) {
       case 'G':
         // Set modal group values
         switch(int_value) {
           case 4: case 10: case 28: case 30: case 53: case 92: group_number = MODAL_GROUP_0; break;
-          case 0: case 1: case 2: case 3: case 80: group_number = MODAL_GROUP_1; break;
+          case 0: case 1: case 2: case 3: case 73: case 80: case 81: case 82: case 83:
+            group_number = MODAL_GROUP_1; break;
           case 17: case 18: case 19: group_number = MODAL_GROUP_2; break;
           case 90: case 91: group_number = MODAL_GROUP_3; break;
           case 93: case 94: group_number = MODAL_GROUP_5; break;
           case 20: case 21: group_number = MODAL_GROUP_6; break;
           case 54: case 55: case 56: case 57: case 58: case 59: group_number = MODAL_GROUP_12; break;
+          case 98: case 99: group_number = MODAL_GROUP_10; break;
         }          
         // Set 'G' commands
         switch(int_value) {
@@ -176,6 +261,7 @@ uint8_t gc_execute_line(char *line) {
           case 21: gc.inches_mode = false; break;
           case 28: case 30: non_modal_action = NON_MODAL_GO_HOME; break;
           case 53: absolute_override = true; break;
+          case 73: gc.motion_mode = MOTION_MODE_DRILL_CHIP_BREAK; break;
           case 54: case 55: case 56: case 57: case 58: case 59:
             int_value -= 54; // Compute coordinate system row index (0=G54,1=G55,...)
             if (int_value < N_COORDINATE_SYSTEM) {
@@ -185,10 +271,13 @@ uint8_t gc_execute_line(char *line) {
             }
             break;
           case 80: gc.motion_mode = MOTION_MODE_CANCEL; break;
+          case 81: gc.motion_mode = MOTION_MODE_DRILL; break;
+          case 82: gc.motion_mode = MOTION_MODE_DRILL_DWELL; break;
+          case 83: gc.motion_mode = MOTION_MODE_DRILL_PECK; break;
           case 90: gc.absolute_mode = true; break;
           case 91: gc.absolute_mode = false; break;
           case 92: 
-            int_value = trunc(10*value); // Multiply by 10 to pick up G92.1
+            int_value = block->words[word].number.code; // Code times 10 picks up G92.1
             switch(int_value) {
               case 920: non_modal_action = NON_MODAL_SET_COORDINATE_OFFSET; break;        
               case 921: non_modal_action = NON_MODAL_RESET_COORDINATE_OFFSET; break;
@@ -197,6 +286,8 @@ uint8_t gc_execute_line(char *line) {
             break;
           case 93: gc.inverse_feed_rate_mode = true; break;
           case 94: gc.inverse_feed_rate_mode = false; break;
+          case 98: gc.retract_to_r = false; break;
+          case 99: gc.retract_to_r = true; break;
           default: FAIL(STATUS_UNSUPPORTED_STATEMENT);
         }
         break;        
@@ -209,10 +300,7 @@ uint8_t gc_execute_line(char *line) {
         // Set 'M' commands
         switch(int_value) {
           case 0: gc.program_flow = PROGRAM_FLOW_PAUSED; break; // Program pause
-          case 1: // Program pause with optional stop on
-            // if (sys.opt_stop) { // TODO: Add system variable for optional stop.
-            gc.program_flow = PROGRAM_FLOW_PAUSED; break; 
-            // }
+          case 1: gc.program_flow = PROGRAM_FLOW_OPTIONAL_PAUSE; break; // Program pause with optional stop on
           case 2: case 30: gc.program_flow = PROGRAM_FLOW_COMPLETED; break; // Program end and reset 
           case 3: gc.spindle_direction = SPINDLE_CW; break;
           case 4: gc.spindle_direction = SPINDLE_CCW; break;
@@ -229,6 +317,28 @@ uint8_t gc_execute_line(char *line) {
           default: FAIL(STATUS_UNSUPPORTED_STATEMENT);
         }            
         break;
+      case 'N': break; // Ignore line numbers
+      case 'F': 
+        if(value <= 0) FAIL(STATUS_INVALID_COMMAND); // Must be greater than zero
+        f = value; bit_true(parameter_words,WORD_F);
+        break;
+      case 'I': case 'J': case 'K': offset[letter - 'I'] = value; break;
+      case 'L': l = int_value; break;
+      case 'P': p = value; bit_true(parameter_words,WORD_P); break;
+      case 'Q': q = value; bit_true(parameter_words,WORD_Q); break;
+      case 'R': r = value; bit_true(parameter_words,WORD_R); break;
+      case 'S': 
+        if(value < 0) FAIL(STATUS_INVALID_COMMAND); // Cannot be negative
+        // We have no support for spindle speed control for now, why waste RAM?
+        break;
+      case 'T': 
+        if(value < 0) FAIL(STATUS_INVALID_COMMAND); // Cannot be negative
+        // We have no support for tool management for now, why waste RAM?
+        break;
+      case 'X': target[X_AXIS] = value; bit_true(axis_words,bit(X_AXIS)); break;
+      case 'Y': target[Y_AXIS] = value; bit_true(axis_words,bit(Y_AXIS)); break;
+      case 'Z': target[Z_AXIS] = value; bit_true(axis_words,bit(Z_AXIS)); break;
+      default: FAIL(STATUS_UNSUPPORTED_STATEMENT); break;
     }    
     // Check for modal group multiple command violations in the current block
     if (group_number) {
@@ -244,44 +354,20 @@ uint8_t gc_execute_line(char *line) {
   // If there were any errors parsing this line, we will return right away with the bad news
   if (gc.status_code) return(gc.status_code);
   
-  /* Pass 2: Parameters. All units converted according to current block commands. Position 
-     parameters are converted and flagged to indicate a change. These can have multiple connotations
-     for different commands. Each will be converted to their proper value upon execution. */
-  float p = 0, r = 0;
-  uint8_t l = 0;
-  char_counter = 0;
-  while(next_statement(&letter, &value, line, &char_counter)) {
-    switch(letter) {
-      case 'G':
-      case 'M':
-      case 'N':
-        break; // Ignore command statements and line numbers
-      case 'F': 
-        if(value <= 0) FAIL(STATUS_INVALID_COMMAND); // Must be greater than zero
-        if(gc.inverse_feed_rate_mode) inverse_feed_rate = to_millimeters(value); // seconds per motion for this motion only
-        else gc.feed_rate = to_millimeters(value); // millimeters per minute
-        break;
-      case 'I': case 'J': case 'K': offset[letter - 'I'] = to_millimeters(value); break;
-      case 'L': l = trunc(value); break;
-      case 'P': p = value; break;                    
-      case 'R': r = to_millimeters(value); break;
-      case 'S': 
-        if(value < 0) FAIL(STATUS_INVALID_COMMAND); // Cannot be negative
-        // We have no support for spindle speed control for now, why waste RAM?
-        break;
-      case 'T': 
-        if(value < 0) FAIL(STATUS_INVALID_COMMAND); // Cannot be negative
-        // We have no support for tool management for now, why waste RAM?
-        break;
-      case 'X': target[X_AXIS] = to_millimeters(value); bit_true(axis_words,bit(X_AXIS)); break;
-      case 'Y': target[Y_AXIS] = to_millimeters(value); bit_true(axis_words,bit(Y_AXIS)); break;
-      case 'Z': target[Z_AXIS] = to_millimeters(value); bit_true(axis_words,bit(Z_AXIS)); break;
-      default: FAIL(STATUS_UNSUPPORTED_STATEMENT); break;
-    }
+  /* Parameters. All units converted according to the commands of the block, now that they are
+     all known. Position parameters are flagged to indicate a change. These can have multiple
+     connotations for different commands. Each will be converted to their proper value upon
+     execution. */
+  if(bit_istrue(parameter_words, WORD_F)) {
+    if(gc.inverse_feed_rate_mode) inverse_feed_rate = to_millimeters(f); // seconds per motion for this motion only
+    else gc.feed_rate = to_millimeters(f); // millimeters per minute
   }
-  
-  // If there were any errors parsing this line, we will return right away with the bad news
-  if(gc.status_code) return(gc.status_code);
+  for(axis = X_AXIS; axis <= Z_AXIS; axis++) {
+    target[axis] = to_millimeters(target[axis]);
+    offset[axis] = to_millimeters(offset[axis]);
+  }
+  q = to_millimeters(q);
+  r = to_millimeters(r);
   
   
   /* Execute Commands: Perform by order of execution defined in NIST RS274-NGC.v3, Table 8, pg.41.
@@ -359,7 +445,7 @@ uint8_t gc_execute_line(char *line) {
       break;
   }
 
-  // [G0,G1,G2,G3,G80]: Perform motion modes. 
+  // [G0,G1,G2,G3,G73,G80,G81,G82,G83]: Perform motion modes. 
   // NOTE: Commands G10,G28,G30,G92 lock out and prevent axis words from use in motion modes. 
   // Enter motion modes only if there are axis words or a motion mode command word in the block.
   if ( bit_istrue(modal_group_words,bit(MODAL_GROUP_1)) || axis_words ) {
@@ -370,6 +456,10 @@ uint8_t gc_execute_line(char *line) {
         FAIL(STATUS_INVALID_COMMAND);
       }
     }
+    // Canned cycles are not possible in inverse time mode.
+    if ( gc.inverse_feed_rate_mode && motion_mode_is_cycle(gc.motion_mode) ) {
+      FAIL(STATUS_INVALID_COMMAND);
+    }
     // Absolute override G53 only valid with G0 and G1 active.
     if ( absolute_override && !(gc.motion_mode == MOTION_MODE_SEEK || gc.motion_mode == MOTION_MODE_LINEAR)) {
       FAIL(STATUS_INVALID_COMMAND);
@@ -377,6 +467,21 @@ uint8_t gc_execute_line(char *line) {
     // Report any errors.  
     if (gc.status_code) return(gc.status_code);
 
+    // Canned cycle parameters stick for as long as the cycle does. The bottom of the hole is
+    // taken before it gets converted like any other axis word, it doesn't follow the same rules.
+    if (motion_mode_is_cycle(gc.motion_mode)) {
+      if (bit_istrue(parameter_words,WORD_P)) { gc.cycle_p = p; }
+      if (bit_istrue(parameter_words,WORD_Q)) { gc.cycle_q = q; }
+      if (bit_istrue(parameter_words,WORD_R)) { gc.cycle_r = r; }
+      if (bit_istrue(axis_words,bit(gc.plane_axis_2))) {
+        gc.cycle_depth = target[gc.plane_axis_2];
+        bit_true(parameter_words,WORD_DEPTH);
+      }
+      gc.cycle_words |= parameter_words & (WORD_P | WORD_Q | WORD_R | WORD_DEPTH);
+    } else {
+      gc.cycle_words = 0;
+    }
+
     // Convert all target position data to machine coordinates for executing motion. Apply
     // absolute mode coordinate offsets or incremental mode offsets.
     // NOTE: Tool offsets may be appended to these conversions when/if this feature is added.
@@ -408,6 +513,52 @@ uint8_t gc_execute_line(char *line) {
         else { mc_line(target[X_AXIS], target[Y_AXIS], target[Z_AXIS], 
           (gc.inverse_feed_rate_mode) ? inverse_feed_rate : gc.feed_rate, gc.inverse_feed_rate_mode); }
         break;
+      case MOTION_MODE_DRILL: case MOTION_MODE_DRILL_DWELL: case MOTION_MODE_DRILL_PECK:
+      case MOTION_MODE_DRILL_CHIP_BREAK:
+        // Need a hole position, R level and bottom of the hole, from this block or an earlier one
+        // of the same cycle. Pecking cycles also need the depth of a peck.
+        if (!axis_words || (gc.cycle_words & (WORD_R | WORD_DEPTH)) != (WORD_R | WORD_DEPTH) ||
+            (gc.motion_mode >= MOTION_MODE_DRILL_PECK && (!bit_istrue(gc.cycle_words,WORD_Q) || gc.cycle_q <= 0)) ||
+            (gc.motion_mode == MOTION_MODE_DRILL_DWELL && gc.cycle_p < 0)) {
+          FAIL(STATUS_INVALID_COMMAND);
+        } else {
+          // Work out the levels along the drill axis. In incremental mode R is relative to where
+          // the block starts from and the bottom of the hole is relative to R.
+          float retract = gc.cycle_r, bottom = gc.cycle_depth, clear;
+          if (gc.absolute_mode) {
+            retract += sys.coord_system[sys.coord_select][gc.plane_axis_2] + sys.coord_offset[gc.plane_axis_2];
+            bottom += sys.coord_system[sys.coord_select][gc.plane_axis_2] + sys.coord_offset[gc.plane_axis_2];
+          } else {
+            retract += gc.position[gc.plane_axis_2];
+            bottom += retract;
+          }
+          if (bottom > retract) { FAIL(STATUS_INVALID_COMMAND); break; }
+          clear = retract;
+          if (!gc.retract_to_r && gc.position[gc.plane_axis_2] > retract) { clear = gc.position[gc.plane_axis_2]; }
+
+          // Drill L holes, all at the same place in absolute mode, each one the same distance
+          // further than the previous in incremental mode.
+          float step_axis0 = target[gc.plane_axis_0] - gc.position[gc.plane_axis_0];
+          float step_axis1 = target[gc.plane_axis_1] - gc.position[gc.plane_axis_1];
+          if (!l) { l = 1; }
+          while (l--) {
+            target[gc.plane_axis_2] = bottom;
+            mc_drill(gc.position, target, gc.plane_axis_2, retract, clear,
+              (gc.motion_mode >= MOTION_MODE_DRILL_PECK) ? gc.cycle_q : 0,
+              gc.motion_mode == MOTION_MODE_DRILL_CHIP_BREAK,
+              (gc.motion_mode == MOTION_MODE_DRILL_DWELL && bit_istrue(gc.cycle_words,WORD_P)) ? gc.cycle_p : 0,
+              gc.feed_rate);
+            if (sys.abort) { break; }
+            target[gc.plane_axis_2] = clear;
+            memcpy(gc.position, target, sizeof(float)*3); // gc.position[] = target[];
+            if (!gc.absolute_mode) {
+              target[gc.plane_axis_0] += step_axis0;
+              target[gc.plane_axis_1] += step_axis1;
+            }
+          }
+          memcpy(target, gc.position, sizeof(float)*3); // target[] = gc.position[]
+        }
+        break;
       case MOTION_MODE_CW_ARC: case MOTION_MODE_CCW_ARC:
         // Check if at least one of the axes of the selected plane has been specified. If in center 
         // format arc mode, also check for at least one of the IJK axes of the selected plane was sent.
@@ -534,44 +685,25 @@ uint8_t gc_execute_line(char *line) {
     memcpy(gc.position, target, sizeof(float)*3); // gc.position[] = target[];
   }
   
-  // M0,M1,M2,M30: Perform non-running program flow actions. During a program pause, the buffer may 
-  // refill and can only be resumed by the cycle start run-time command.
-  if (gc.program_flow) {
-    plan_synchronize(); // Finish all remaining buffered motions. Program paused when complete.
-    sys.auto_start = false; // Disable auto cycle start.
-    gc.program_flow = PROGRAM_FLOW_RUNNING; // Re-enable program flow after pause complete.
-    
-    // If complete, reset to reload defaults (G92.2,G54,G17,G90,G94,M48,G40,M5,M9)
-    if (gc.program_flow == PROGRAM_FLOW_COMPLETED) { sys.abort = true; }
-  }    
+  // M0,M1,M2,M30: Perform non-running program flow actions. A pause is queued behind the motions
+  // before it, parsing carries on and the buffer may refill, resuming only with the cycle start
+  // run-time command.
+  if (gc.program_flow == PROGRAM_FLOW_PAUSED || gc.program_flow == PROGRAM_FLOW_OPTIONAL_PAUSE) {
+    mc_pause(gc.program_flow == PROGRAM_FLOW_OPTIONAL_PAUSE);
+  } else if (gc.program_flow == PROGRAM_FLOW_COMPLETED) {
+    mc_synchronize(); // Finish all remaining queued and buffered motions.
+    // Complete, reset to reload defaults (G92.2,G54,G17,G90,G94,M48,G40,M5,M9)
+    sys.abort = true;
+  }
+  gc.program_flow = PROGRAM_FLOW_RUNNING; // Re-enable program flow.
   
   return(gc.status_code);
 }
 
-// Parses the next statement and leaves the counter on the first character following
-// the statement. Returns 1 if there was a statements, 0 if end of string was reached
-// or there was an error (check state.status_code).
-static bool next_statement(char *letter, float *float_ptr, char *line, uint8_t *char_counter) {
-  if(!line[*char_counter]) return false; // No more statements
-  
-  *letter = line[*char_counter];
-  if((*letter < 'A') || (*letter > 'Z')) {
-    FAIL(STATUS_EXPECTED_COMMAND_LETTER);
-    return false;
-  }
-  (*char_counter)++;
-  if(!read_float(line, char_counter, float_ptr)) {
-    FAIL(STATUS_BAD_NUMBER_FORMAT); 
-    return false;
-  }
-
-  return true;
-}
-
 /* 
   Not supported:
 
-  - Canned cycles
+  - Canned cycles other than G73, G81, G82 and G83
   - Tool radius compensation
   - A,B,C-axes
   - Evaluation of expressions
@@ -583,7 +715,7 @@ static bool next_statement(char *letter, float *float_ptr, char *line, uint8_t *
   - Tool changes
 
    group 0 = {G92.2, G92.3} (Non modal: Cancel and re-enable G92 offsets)
-   group 1 = {G38.2, G81 - G89} (Motion modes: straight probe, canned cycles)
+   group 1 = {G38.2, G84 - G89} (Motion modes: straight probe, canned cycles)
    group 6 = {M6} (Tool change)
    group 9 = {M48, M49} enable/disable feed and speed override switches
    group 12 = {G55, G56, G57, G58, G59, G59.1, G59.2, G59.3} coordinate system selection
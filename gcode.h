@@ -25,13 +25,58 @@
 
 #include <stdint.h>
 
+#include "nuts_bolts.h"
+
 // Initialize the parser
 void gc_init();
 
+// Maximum number of words in a block
+#define GC_BLOCK_WORDS 16
+
+// Words whose value is an integer code rather than a quantity. Their values are read as integers
+// scaled by 10, which keeps the one decimal some codes have (e.g. 921 for G92.1), with no floating
+// point work at all.
+#define gc_is_code_word(letter) ((letter) == 'G' || (letter) == 'M' || (letter) == 'N' || \
+    (letter) == 'L')
+
+// One word of a block: a letter and the value following it
+typedef struct {
+  char letter;
+  union {
+    float value;  // All other words
+    int32_t code; // Code words, times 10
+  } number;
+} gc_word_t;
+
+// A block of g-code, split into words as it arrives
+typedef struct {
+  uint8_t count;                  // Number of words
+  uint8_t status;                 // First error met while splitting the block
+  uint8_t inword;                 // Flag telling that a word letter was read and its value is being read
+  number_reader_t reader;         // Value of the word being read
+  gc_word_t words[GC_BLOCK_WORDS];
+} gc_block_t;
+
+// Split one block of g-code into words as it arrives: start with gc_block_start(), then feed every
+// character with gc_block_feed() and finish with gc_block_finish(). Characters must be upper case
+// with comments and whitespace removed. Both return the status of the block so far.
+void gc_block_start(gc_block_t *block);
+uint8_t gc_block_feed(gc_block_t *block, char c);
+uint8_t gc_block_finish(gc_block_t *block);
+
 // Execute one block of rs275/ngc/g-code
-uint8_t gc_execute_line(char *line);
+uint8_t gc_execute_block(gc_block_t *block);
 
 // Set g-code parser position. Input in steps.
 void gc_set_current_position(int32_t x, int32_t y, int32_t z); 
 
+// Get/set g-code parser position, in absolute machine coordinates (mm). Used by command sources
+// other than g-code to keep the parser in step with the moves they make.
+void gc_get_position(float *position);
+void gc_set_position(float *position);
+
+// Change spindle and coolant state the way M3/M4/M5 and M7/M8/M9 would.
+void gc_set_spindle_direction(int8_t direction);
+void gc_set_coolant_state(uint8_t mode);
+
 #endif
@@ -37,13 +37,37 @@ THostSettingStatus host_settings_fetch(const uint16_t signature,
     void *settings, const size_t size);
 
 /* Host serial console baud rate. Low-level functions are in the
- * architecture-specific header file */
-#define CONSOLE_BAUD_RATE 9600
-/* Host serial console Rx and Tx ring buffer sizes, in bytes */
-#define CONSOLE_RXBUF_SIZE 128
-#define CONSOLE_TXBUF_SIZE 16
-/* Host serial console will readback this value when there's nothing to read */
-#define CONSOLE_NO_DATA 0xFF
+ * architecture-specific header file. Override on the compiler command line
+ * (e.g. -DCONSOLE_BAUD_RATE=115200); 115200 and 250000 work well on a 16MHz
+ * ATmega328p, the latter with no rate error at all */
+#ifndef CONSOLE_BAUD_RATE
+# define CONSOLE_BAUD_RATE 9600
+#endif
+/* Host serial console Rx and Tx ring buffer sizes, in bytes. Override as
+ * above, rings larger than 256 bytes get 16-bit indices. The Tx ring must
+ * hold at least an "ok\r\n" for acknowledgements not to block */
+#ifndef CONSOLE_RXBUF_SIZE
+# define CONSOLE_RXBUF_SIZE 128
+#endif
+#ifndef CONSOLE_TXBUF_SIZE
+# define CONSOLE_TXBUF_SIZE 64
+#endif
+#if CONSOLE_RXBUF_SIZE < 2 || CONSOLE_RXBUF_SIZE > 65535 || \
+    CONSOLE_TXBUF_SIZE < 2 || CONSOLE_TXBUF_SIZE > 65535
+# error Console ring buffer sizes must be between 2 and 65535 bytes
+#endif
+/* Host serial console will readback this value when there's nothing to read.
+ * Outside of the 0-255 range of received bytes, which may be anything at all
+ * when they are part of a binary frame */
+#define CONSOLE_NO_DATA -1
+/* Host serial console receive filter. Gets to see every received character
+ * first, at interrupt level on architectures that have one, and returns true
+ * if it consumed the character which then never makes it to the Rx ring
+ * buffer. Used for real-time commands that must not queue behind data. */
+typedef bool (*THostSerialConsoleFilter)(char c);
+void host_serialconsole_set_filter(THostSerialConsoleFilter filter);
+/* Host serial console free Rx ring buffer space, in bytes */
+uint16_t host_serialconsole_rx_free(void);
 /* Host serial console variable string output. Blocks until buffer space is
  * available if block is set to true, returns false if in non-blocking mode and
  * no buffer space */
@@ -16,6 +16,7 @@
 
 #include <avr/io.h>
 #include <avr/power.h>
+#include <util/atomic.h>
 #include <util/delay.h>
 #include <util/delay_basic.h>
 
@@ -45,12 +46,32 @@ void host_delay_us(uint16_t us) {
   _delay_loop_2(us);
 }
 
+/* Ring buffer indices only get wider than a byte when they have to. Indices
+ * shared with the interrupt handlers must then be accessed atomically */
+#if CONSOLE_RXBUF_SIZE > 256
+typedef uint16_t TSerialConsoleRxIndex;
+# define serialconsole_rx_atomic(statement) \
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { statement; }
+#else
+typedef uint8_t TSerialConsoleRxIndex;
+# define serialconsole_rx_atomic(statement) { statement; }
+#endif
+#if CONSOLE_TXBUF_SIZE > 256
+typedef uint16_t TSerialConsoleTxIndex;
+# define serialconsole_tx_atomic(statement) \
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { statement; }
+#else
+typedef uint8_t TSerialConsoleTxIndex;
+# define serialconsole_tx_atomic(statement) { statement; }
+#endif
+
 static char serialconsole_rx_buffer[CONSOLE_RXBUF_SIZE];
-static volatile uint8_t serialconsole_rx_buffer_head = 0;
-static uint8_t serialconsole_rx_buffer_tail = 0;
+static volatile TSerialConsoleRxIndex serialconsole_rx_buffer_head = 0;
+static TSerialConsoleRxIndex serialconsole_rx_buffer_tail = 0;
 static char serialconsole_tx_buffer[CONSOLE_TXBUF_SIZE];
-static uint8_t serialconsole_tx_buffer_head = 0;
-static volatile uint8_t serialconsole_tx_buffer_tail = 0;
+static TSerialConsoleTxIndex serialconsole_tx_buffer_head = 0;
+static volatile TSerialConsoleTxIndex serialconsole_tx_buffer_tail = 0;
+static THostSerialConsoleFilter serialconsole_filter = NULL;
 
 void host_serialconsole_init(void) {
 #define BAUD CONSOLE_BAUD_RATE
@@ -69,31 +90,53 @@ void host_serialconsole_init(void) {
 }
 
 void host_serialconsole_reset(void) {
-  serialconsole_rx_buffer_tail = serialconsole_rx_buffer_head;
+  serialconsole_rx_atomic(
+      serialconsole_rx_buffer_tail = serialconsole_rx_buffer_head);
+}
+
+void host_serialconsole_set_filter(THostSerialConsoleFilter filter) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) serialconsole_filter = filter;
 }
 
-char host_serialconsole_read(void) {
-  if(serialconsole_rx_buffer_head == serialconsole_rx_buffer_tail)
+uint16_t host_serialconsole_rx_free(void) {
+  TSerialConsoleRxIndex head;
+
+  serialconsole_rx_atomic(head = serialconsole_rx_buffer_head);
+
+  if(head >= serialconsole_rx_buffer_tail)
+    return CONSOLE_RXBUF_SIZE - 1 - (head - serialconsole_rx_buffer_tail);
+  else return serialconsole_rx_buffer_tail - head - 1;
+}
+
+int host_serialconsole_read(void) {
+  TSerialConsoleRxIndex head, tail = serialconsole_rx_buffer_tail;
+
+  serialconsole_rx_atomic(head = serialconsole_rx_buffer_head);
+  if(head == tail)
     return CONSOLE_NO_DATA;
   else {
-    uint8_t data = serialconsole_rx_buffer[serialconsole_rx_buffer_tail];
-    if (++serialconsole_rx_buffer_tail == CONSOLE_RXBUF_SIZE)
-      serialconsole_rx_buffer_tail = 0;
+    uint8_t data = serialconsole_rx_buffer[tail];
+    if (++tail == CONSOLE_RXBUF_SIZE)
+      tail = 0;
+    serialconsole_rx_atomic(serialconsole_rx_buffer_tail = tail);
 
     return data;
   }
 }
 
 bool host_serialconsole_write(char c, bool block) {
-  uint8_t new_head =
+  TSerialConsoleTxIndex tail, new_head =
       ((serialconsole_tx_buffer_head + 1) == CONSOLE_TXBUF_SIZE)
       ? 0 : serialconsole_tx_buffer_head + 1;
 
-  while (new_head == serialconsole_tx_buffer_tail)
+  while (true) {
+    serialconsole_tx_atomic(tail = serialconsole_tx_buffer_tail);
+    if(new_head != tail) break;
     if(!block) return false;
+  }
 
   serialconsole_tx_buffer[serialconsole_tx_buffer_head] = c;
-  serialconsole_tx_buffer_head = new_head;
+  serialconsole_tx_atomic(serialconsole_tx_buffer_head = new_head);
 
   UCSR0B |= _BV(UDRIE0);
 
@@ -145,7 +188,10 @@ ISR(USART_RX_vect)
 {
   /* Need to actually perform the read to clear "data received" status */
   char data = UDR0;
-  uint8_t new_head = ((serialconsole_rx_buffer_head + 1) == CONSOLE_RXBUF_SIZE)
+  TSerialConsoleRxIndex new_head;
+
+  if(serialconsole_filter && serialconsole_filter(data)) return;
+  new_head = ((serialconsole_rx_buffer_head + 1) == CONSOLE_RXBUF_SIZE)
       ? 0 : serialconsole_rx_buffer_head + 1;
 
   if(new_head != serialconsole_rx_buffer_tail) {
@@ -37,6 +37,10 @@
 
 /* Host-specific interrupt enable */
 #define host_sei() sei()
+/* Host-specific interrupt disable */
+#define host_cli() cli()
+/* Host-specific idle hook */
+#define host_idle() // NOP on AVR, interrupts come in on their own
 /* Host-specific interrupt vector declaration */
 #define HOST_INTERRUPT(x) ISR(x)
 /* Host-specific interrupt vector registration */
@@ -53,6 +57,10 @@ void host_delay_us(uint16_t us);
 #define _S_t(s) s PROGMEM
 /* ... (access method) */
 #define host_fetch_S(s) pgm_read_byte(s)
+/* Host-specific constant table treatment (type) */
+#define _T_t(t) t PROGMEM
+/* ... (access method for 16-bit entries) */
+#define host_fetch_W(w) pgm_read_word(w)
 
 /* Host-specific NVS methods */
 #if __AVR_LIBC_VERSION__ >= 10607UL
@@ -75,8 +83,8 @@ void host_delay_us(uint16_t us);
 /* Serial console interface */
 void host_serialconsole_init();
 void host_serialconsole_reset();
-/* Returns CONSOLE_NO_DATA if nothing to read */
-char host_serialconsole_read(void);
+/* Returns the next received byte, or CONSOLE_NO_DATA if nothing to read */
+int host_serialconsole_read(void);
 /* Blocks until buffer space is available if block is set to true, returns
  * false if in non-blocking mode and no buffer space */
 bool host_serialconsole_write(char c, bool block);
@@ -245,7 +253,7 @@ bool host_serialconsole_printfloat(float n, uint8_t precision, bool block);
 
 /* Host Timer interface */
 typedef struct {
-    uint16_t divisor;
+    uint8_t shift; /* log2(divisor), prescalers are always powers of two */
     uint8_t flags;
 } THostTimerPrescaler;
 /* Frequency at which the timers count if prescalers are set to unity */
@@ -258,6 +266,9 @@ typedef struct {
 #define HOST_TIMER_INTERRUPT_COMPARE_A_vector COMPA
 #define HOST_TIMER_INTERRUPT_COMPARE_B_flag __avr_ocie_of_timer_helperB
 #define HOST_TIMER_INTERRUPT_COMPARE_B_vector COMPB
+#define HOST_TIMER_INTERRUPT_OVERFLOW_pending __avr_tov_of_timer
+#define HOST_TIMER_INTERRUPT_COMPARE_A_pending __avr_ocf_of_timer_helperA
+#define HOST_TIMER_INTERRUPT_COMPARE_B_pending __avr_ocf_of_timer_helperB
 #define HOST_TIMER_PRESCALER_COUNT_0 5
 #define HOST_TIMER_PRESCALER_0_0 0x00
 #define HOST_TIMER_PRESCALER_0_1 _BV(__avr_cs_of_output(0,0))
@@ -266,11 +277,11 @@ typedef struct {
 #define HOST_TIMER_PRESCALER_0_256 _BV(__avr_cs_of_output(0,2))
 #define HOST_TIMER_PRESCALER_0_1024 _BV(__avr_cs_of_output(0,0)) | _BV(__avr_cs_of_output(0,2))
 #define HOST_TIMER_PRESCALERS_0 {\
-    {1, HOST_TIMER_PRESCALER_0_1},\
-    {8, HOST_TIMER_PRESCALER_0_8},\
-    {64, HOST_TIMER_PRESCALER_0_64},\
-    {256, HOST_TIMER_PRESCALER_0_256},\
-    {1024, HOST_TIMER_PRESCALER_0_1024}}
+    {0, HOST_TIMER_PRESCALER_0_1},\
+    {3, HOST_TIMER_PRESCALER_0_8},\
+    {6, HOST_TIMER_PRESCALER_0_64},\
+    {8, HOST_TIMER_PRESCALER_0_256},\
+    {10, HOST_TIMER_PRESCALER_0_1024}}
 #define HOST_TIMER_PRESCALER_COUNT_1 5
 #define HOST_TIMER_PRESCALER_1_0 0x00
 #define HOST_TIMER_PRESCALER_1_1 _BV(__avr_cs_of_output(1,0))
@@ -279,11 +290,11 @@ typedef struct {
 #define HOST_TIMER_PRESCALER_1_256 _BV(__avr_cs_of_output(1,2))
 #define HOST_TIMER_PRESCALER_1_1024 _BV(__avr_cs_of_output(1,0)) | _BV(__avr_cs_of_output(1,2))
 #define HOST_TIMER_PRESCALERS_1 {\
-    {1, HOST_TIMER_PRESCALER_1_1},\
-    {8, HOST_TIMER_PRESCALER_1_8},\
-    {64, HOST_TIMER_PRESCALER_1_64},\
-    {256, HOST_TIMER_PRESCALER_1_256},\
-    {1024, HOST_TIMER_PRESCALER_1_1024}}
+    {0, HOST_TIMER_PRESCALER_1_1},\
+    {3, HOST_TIMER_PRESCALER_1_8},\
+    {6, HOST_TIMER_PRESCALER_1_64},\
+    {8, HOST_TIMER_PRESCALER_1_256},\
+    {10, HOST_TIMER_PRESCALER_1_1024}}
 #define HOST_TIMER_PRESCALER_COUNT_2 7
 #define HOST_TIMER_PRESCALER_2_0 0x00
 #define HOST_TIMER_PRESCALER_2_1 _BV(__avr_cs_of_output(2,0))
@@ -294,13 +305,13 @@ typedef struct {
 #define HOST_TIMER_PRESCALER_2_256 _BV(__avr_cs_of_output(2,1)) | _BV(__avr_cs_of_output(2,2))
 #define HOST_TIMER_PRESCALER_2_1024 _BV(__avr_cs_of_output(2,0)) | _BV(__avr_cs_of_output(2,1)) | _BV(__avr_cs_of_output(2,2))
 #define HOST_TIMER_PRESCALERS_2 {\
-    {1, HOST_TIMER_PRESCALER_2_1},\
-    {8, HOST_TIMER_PRESCALER_2_8},\
-    {32, HOST_TIMER_PRESCALER_2_32},\
-    {64, HOST_TIMER_PRESCALER_2_64},\
-    {128, HOST_TIMER_PRESCALER_2_128},\
-    {256, HOST_TIMER_PRESCALER_2_256},\
-    {1024, HOST_TIMER_PRESCALER_2_1024}}
+    {0, HOST_TIMER_PRESCALER_2_1},\
+    {3, HOST_TIMER_PRESCALER_2_8},\
+    {5, HOST_TIMER_PRESCALER_2_32},\
+    {6, HOST_TIMER_PRESCALER_2_64},\
+    {7, HOST_TIMER_PRESCALER_2_128},\
+    {8, HOST_TIMER_PRESCALER_2_256},\
+    {10, HOST_TIMER_PRESCALER_2_1024}}
 #define HOST_TIMER_COMPARE_MAX_0 0x100UL
 #define HOST_TIMER_COMPARE_MAX_1 0x10000UL
 #define HOST_TIMER_COMPARE_MAX_2 0x100UL
@@ -313,6 +324,14 @@ typedef struct {
 #define __avr_ocie_of_timer(timer,channel) ___avr_ocie_of_timer(timer,channel)
 #define __avr_ocie_of_timer_helperA(timer) __avr_ocie_of_timer(timer,A)
 #define __avr_ocie_of_timer_helperB(timer) __avr_ocie_of_timer(timer,B)
+#define ___avr_tov_of_timer(timer) TOV ## timer
+#define __avr_tov_of_timer(timer) ___avr_tov_of_timer(timer)
+#define ___avr_ocf_of_timer(timer,channel) OCF ## timer ## channel
+#define __avr_ocf_of_timer(timer,channel) ___avr_ocf_of_timer(timer,channel)
+#define __avr_ocf_of_timer_helperA(timer) __avr_ocf_of_timer(timer,A)
+#define __avr_ocf_of_timer_helperB(timer) __avr_ocf_of_timer(timer,B)
+#define ___avr_tifr_of_timer(timer) TIFR ## timer
+#define __avr_tifr_of_timer(timer) ___avr_tifr_of_timer(timer)
 #define host_timer_set_compare(timer,channel,value) __avr_ocr_of_output(timer,channel) = value
 #define ___avr_ie_of_timer(timer,which) which ## _ ## timer
 #define __avr_ie_of_timer(timer,which) ___avr_ie_of_timer(timer,which)
@@ -322,6 +341,12 @@ typedef struct {
 #define host_timer_enable_interrupt(timer,which) _host_timer_enable_interrupt(timer,__avr_if_of_timer(which))
 #define _host_timer_disable_interrupt(timer,which) __avr_timsk_of_output(timer) &= ~_BV(which(timer))
 #define host_timer_disable_interrupt(timer,which) _host_timer_disable_interrupt(timer,__avr_if_of_timer(which))
+#define ___avr_ip_of_timer(which) which ## _pending
+#define __avr_ip_of_timer(which) ___avr_ip_of_timer(which)
+/* True if the given interrupt condition has occurred again and is waiting to
+ * be serviced, e.g. a compare match while its own handler is still running */
+#define _host_timer_interrupt_pending(timer,which) bit_is_set(__avr_tifr_of_timer(timer),which(timer))
+#define host_timer_interrupt_pending(timer,which) _host_timer_interrupt_pending(timer,__avr_ip_of_timer(which))
 #define ___avr_timer_vector_name(timer,which) TIMER ## timer ## _ ## which ## _vect
 #define __avr_timer_vector_name(timer,which) ___avr_timer_vector_name(timer,which)
 #define ___avr_timer_vector_type(which) which ## _vector
@@ -339,27 +364,43 @@ typedef struct {
 #define _host_timer_enable_ctc(timer) HOST_TIMER_CTC_ ## timer
 #define host_timer_enable_ctc(timer) _host_timer_enable_ctc(timer)
 /* Sets up given timer for CTC mode for a period of cycles cycles. Actual
- * achievable cycles is returned in actual_cycles. */
+ * achievable cycles is returned in actual_cycles. Prescalers being powers of
+ * two, this only shifts and never multiplies or divides so that it can be
+ * called from within interrupt handlers at a bounded cost. */
 #define host_timer_set_reload(timer,cycles,actual_cycles) {\
   uint8_t i; \
-  THostTimerPrescaler prescalers[] = host_prescalers_of_timer(timer); \
+  static const THostTimerPrescaler prescalers[] = host_prescalers_of_timer(timer); \
   uint16_t ceiling = 0; \
   for(i = 0; i < host_prescaler_count_of_timer(timer); i++) {\
-    if((cycles) < host_compare_max_of_timer(timer) * prescalers[i].divisor) {\
-      ceiling = (cycles) / prescalers[i].divisor; \
+    if(((cycles) >> prescalers[i].shift) < host_compare_max_of_timer(timer)) {\
+      ceiling = (cycles) >> prescalers[i].shift; \
       host_timer_set_compare(timer,HOST_TIMER_CHANNEL_A,ceiling); \
-      actual_cycles = ceiling * prescalers[i].divisor; \
+      actual_cycles = (uint32_t)ceiling << prescalers[i].shift; \
       host_timer_enable_ctc(timer); \
       host_timer_set_prescaler(timer,prescalers[i].flags); \
       break; \
     }\
   }\
   if(!ceiling) {\
+    if(i == host_prescaler_count_of_timer(timer)) i--; \
     host_timer_set_compare(timer,HOST_TIMER_CHANNEL_A,host_compare_max_of_timer(timer) - 1); \
-    actual_cycles = (host_compare_max_of_timer(timer) - 1) * prescalers[i].divisor; \
+    actual_cycles = (host_compare_max_of_timer(timer) - 1) << prescalers[i].shift; \
     host_timer_enable_ctc(timer); \
     host_timer_set_prescaler(timer,prescalers[i].flags); \
   }}
+/* Returns the number of CPU cycles elapsed since the given timer last started
+ * counting from zero (i.e. since the last compare match in CTC mode). Meant
+ * for measuring how long a timer interrupt handler has been running for. */
+#define HOST_TIMER_PRESCALER_SHIFTS_0 {0, 0, 3, 6, 8, 10, 0, 0}
+#define HOST_TIMER_PRESCALER_SHIFTS_1 {0, 0, 3, 6, 8, 10, 0, 0}
+#define HOST_TIMER_PRESCALER_SHIFTS_2 {0, 0, 3, 5, 6, 7, 8, 10}
+#define _host_prescaler_shifts_of_timer(timer) HOST_TIMER_PRESCALER_SHIFTS_ ## timer
+#define host_prescaler_shifts_of_timer(timer) _host_prescaler_shifts_of_timer(timer)
+#define host_timer_get_elapsed_cycles(timer) ({\
+  static const uint8_t shifts[] = host_prescaler_shifts_of_timer(timer); \
+  (uint32_t)__avr_tcnt_of_timer(timer) << shifts[__avr_tccr_of_output(timer,B) & \
+      (_BV(__avr_cs_of_output(timer,2)) | _BV(__avr_cs_of_output(timer,1)) | \
+      _BV(__avr_cs_of_output(timer,0)))]; })
 
 /* Host waveform generator interface */
 /* Starts generating the given waveform at the given frequency on the given
@@ -18,10 +18,52 @@
 #define EVENT_TIMER_COMPARE_B 0x03
 
 #define NVS_STORE_NAME "host-nvs.bin"
+#define NVS_MEMORY_SIZE 1024 // In-memory container, as much EEPROM as an ATmega328p has
 
 #define TIMER_MODE_NORMAL 0x01
 #define TIMER_MODE_CTC 0x02
 
+#define EVENT_NOT_QUEUED 0xFF
+#define EVENT_NEVER UINT64_MAX
+
+/* Virtual cycles it takes a console character to come in, 8N1 */
+#define CONSOLE_CHAR_CYCLES (10 * HOST_TIMER_FOSC / CONSOLE_BAUD_RATE)
+
+/* Log levels, selected with -l on the command line */
+#define LOG_QUIET 0 // Nothing but what grbl prints on its console
+#define LOG_SETUP 1 // ... plus HAL, NVS and pin setup
+#define LOG_TRACE 2 // ... plus every pin change, timer change and interrupt
+#define _i386_log(level, ...) \
+  do { if(logLevel >= (level)) printf(__VA_ARGS__); } while(0)
+
+/* Binary trace (-t on the command line): a TTraceHeader followed by one
+ * TTraceRecord per event, both in host byte order. Records are fixed size so
+ * the file can be mmap()-ed and indexed directly. See script/trace_decode.py,
+ * keep it in sync with these. */
+#define TRACE_MAGIC "GRBLTRC"
+#define TRACE_VERSION 1
+#define TRACE_BUFFER_SIZE 0x100000UL
+#define TRACE_GPIO_WRITE 0x01 // id: output, value: level
+#define TRACE_GPIO_DIRECTION 0x02 // id: output, value: direction
+#define TRACE_INTERRUPTS 0x03 // value: globally enabled
+#define TRACE_VECTOR_ENTER 0x04 // id: timer, arg: event
+#define TRACE_VECTOR_EXIT 0x05 // id: timer, arg: event
+#define TRACE_INTERRUPT_ENABLE 0x06 // id: timer, arg: event, value: enabled
+#define TRACE_TIMER_COMPARE 0x07 // id: timer, arg: channel, value: compare
+#define TRACE_TIMER_COUNT 0x08 // id: timer, value: count
+#define TRACE_TIMER_PRESCALER 0x09 // id: timer, value: prescaler
+#define TRACE_TIMER_CTC 0x0A // id: timer
+#define TRACE_FG_START 0x0B // id: output, value: frequency
+#define TRACE_FG_STOP 0x0C // id: output
+
+/* Value Change Dump (-w on the command line) of all GPIO outputs, plus one
+ * event per timer interrupt dispatched, for viewing in e.g. GTKWave. Times
+ * are virtual, in picoseconds so that a CPU cycle is a whole number of them. */
+#define VCD_PS_PER_CYCLE (UINT64_C(1000000000000) / HOST_TIMER_FOSC)
+#define VCD_GPIO_CODE(output) ('!' + (output))
+#define VCD_VECTOR_CODE(timer,event) \
+  ('a' + (timer) * 3 + (event) - EVENT_TIMER_OVERFLOW)
+
 // Record types
 typedef struct {
   const uint16_t *pDivisors;
@@ -41,27 +83,60 @@ typedef struct {
   uint16_t prescaler;
   bool wide;
   uint8_t mode;
+  uint64_t lastInterrupt; // Virtual cycle its last interrupt was dispatched at
+  uint64_t since; // Virtual cycle count was last brought up to date at
 } TTimerDescriptor;
 
 typedef struct {
-  uint32_t remaining;
+  uint64_t due; // Virtual cycle this fires at
   uint8_t timer;
   uint8_t event;
+  uint8_t slot; // Position in the event heap, EVENT_NOT_QUEUED if not in it
   void(*vector)(void);
 } TTimerEventSpec;
 
+typedef struct {
+  char magic[8];
+  uint16_t version;
+  uint16_t recordSize;
+  uint32_t fosc; // Virtual cycles per second
+} TTraceHeader;
+
+typedef struct {
+  uint64_t cycles; // Virtual time the event happened at
+  uint32_t value;
+  uint8_t type;
+  uint8_t id;
+  uint8_t arg;
+  uint8_t reserved;
+} TTraceRecord;
+
 // Local functions
 static int _i386_compare_interrupts(const void *a, const void *b);
-static int _i386_compare_timer_events(const void *a, const void *b);
-static bool _i386_update_event_list(void);
-static bool _i386_advance_timer(uint8_t timer, uint8_t event);
-static void _i386_do_interrupt_work(void);
+static bool _i386_event_before(const TTimerEventSpec *a, const TTimerEventSpec *b);
+static void _i386_heap_swap(uint8_t a, uint8_t b);
+static void _i386_heap_up(uint8_t slot);
+static void _i386_heap_down(uint8_t slot);
+static void _i386_heap_remove(TTimerEventSpec *spec);
+static uint32_t _i386_timer_top(uint8_t timer);
+static void _i386_timer_sync(uint8_t timer);
+static uint64_t _i386_timer_due(uint8_t timer, uint8_t event);
+static void _i386_schedule_event(uint8_t timer, uint8_t event);
+static void _i386_rearm_timer(uint8_t timer);
+static bool _i386_do_interrupt_work(uint64_t until);
 static TInterruptDescriptor *_i386_interrupt_by_name(const char *name);
 static TInterruptDescriptor *_i386_timer_interrupt_by_type(uint8_t timer,
     uint8_t which);
 static void _i386_init_nvs(const char *fileName);
+static void _i386_init_trace(const char *fileName);
+static void _i386_trace(uint8_t type, uint8_t id, uint8_t arg, uint32_t value);
+static void _i386_init_vcd(const char *fileName);
+static void _i386_vcd_time(void);
+static void _i386_vcd_gpio(uint8_t output, uint8_t value);
+static void _i386_vcd_vector(uint8_t timer, uint8_t event);
 static void _i386_nvs_write(const void *data, size_t size, long int offset);
 static void _i386_nvs_read(void *data, size_t size, long int offset);
+static void _i386_exit(const char *reason);
 void _i386_exit_handler(int signum);
 
 
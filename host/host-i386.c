@@ -16,7 +16,7 @@
 #include <string.h>
 
 #include <signal.h>
-#include <time.h>
+#include <unistd.h>
 
 #include "host.h"
 #include "host-i386-private.h"
@@ -67,30 +67,56 @@ static TInterruptDescriptor interrupts[] = {
   {"T2_O_V", false, NULL}
 };
 static FILE *nvs;
+static bool nvsPrivate = false;
+static uint8_t nvsMemory[NVS_MEMORY_SIZE];
+static FILE *trace;
+static FILE *vcd;
+static uint64_t vcdTime = EVENT_NEVER; // Last time stamp written to vcd
+static char vcdLevels[sizeof(gpioNames) / sizeof(gpioNames[0])];
+static uint8_t logLevel = LOG_TRACE;
+static THostInterruptHook interruptHook = NULL;
+static THostSerialConsoleFilter serialconsoleFilter = NULL;
 static TTimerDescriptor timers[] = {
   {0x00, {0x00, 0x00}, 0, false, TIMER_MODE_NORMAL},
   {0x0000, {0x0000, 0x0000}, 0, true, TIMER_MODE_NORMAL},
   {0x00, {0x00, 0x00}, 0, false, TIMER_MODE_NORMAL}
 };
+/* One entry per timer and event, in that order. Those that will fire are kept
+ * in a binary min-heap on their due time, so that finding the next one is
+ * O(1) and rearming one is O(log n). */
 static TTimerEventSpec timerEvents[] = {
-    {0x0000, 0, EVENT_TIMER_OVERFLOW, NULL},
-    {0x0000, 0, EVENT_TIMER_OVERFLOW, NULL},
-    {0x0000, 0, EVENT_TIMER_OVERFLOW, NULL},
-    {0x0000, 1, EVENT_TIMER_COMPARE_A, NULL},
-    {0x0000, 1, EVENT_TIMER_COMPARE_A, NULL},
-    {0x0000, 1, EVENT_TIMER_COMPARE_A, NULL},
-    {0x0000, 2, EVENT_TIMER_COMPARE_B, NULL},
-    {0x0000, 2, EVENT_TIMER_COMPARE_B, NULL},
-    {0x0000, 2, EVENT_TIMER_COMPARE_B, NULL}
+    {EVENT_NEVER, 0, EVENT_TIMER_OVERFLOW, EVENT_NOT_QUEUED, NULL},
+    {EVENT_NEVER, 0, EVENT_TIMER_COMPARE_A, EVENT_NOT_QUEUED, NULL},
+    {EVENT_NEVER, 0, EVENT_TIMER_COMPARE_B, EVENT_NOT_QUEUED, NULL},
+    {EVENT_NEVER, 1, EVENT_TIMER_OVERFLOW, EVENT_NOT_QUEUED, NULL},
+    {EVENT_NEVER, 1, EVENT_TIMER_COMPARE_A, EVENT_NOT_QUEUED, NULL},
+    {EVENT_NEVER, 1, EVENT_TIMER_COMPARE_B, EVENT_NOT_QUEUED, NULL},
+    {EVENT_NEVER, 2, EVENT_TIMER_OVERFLOW, EVENT_NOT_QUEUED, NULL},
+    {EVENT_NEVER, 2, EVENT_TIMER_COMPARE_A, EVENT_NOT_QUEUED, NULL},
+    {EVENT_NEVER, 2, EVENT_TIMER_COMPARE_B, EVENT_NOT_QUEUED, NULL}
 };
-
-
+static TTimerEventSpec *eventHeap[sizeof(timerEvents) / sizeof(timerEvents[0])];
+static uint8_t eventCount = 0;
+/* Simulated CPU clock, in HOST_TIMER_FOSC cycles since startup */
+static uint64_t virtualCycles = 0;
+/* Console input comes from a host streaming as fast as the line and grbl's Rx
+ * ring allow (like script/stream.py): one byte per CONSOLE_CHAR_CYCLES while
+ * there is room for it, stdin only supplies what the bytes are. */
+static uint64_t rxArrival = 0; // When the next byte is in, room permitting
+static uint16_t rxHeld = 0; // Bytes in the (virtual) Rx ring
+static bool rxEOF = false;
+
+#define _i386_timer_event(timer,event) \
+  (&timerEvents[(timer) * 3 + (event) - EVENT_TIMER_OVERFLOW])
+
+
+/* Delays take no wall-clock time, they advance the simulated CPU clock instead
+ * and dispatch whatever timer interrupts fall due meanwhile */
 void i386_delay_us(uint32_t us) {
-  struct timespec before, after;
+  uint64_t until = virtualCycles + (uint64_t)us * (HOST_TIMER_FOSC / 1000000UL);
 
-  before.tv_sec = us / 1000000;
-  before.tv_nsec = (us % 1000000) * 1000UL;
-  while(nanosleep(&before, &after)) before = after;
+  if(interruptsEnabled) _i386_do_interrupt_work(until);
+  if(virtualCycles < until) virtualCycles = until;
 }
 
 /* Exact implementations of the C code from AVR's util/crc16.h */
@@ -117,21 +143,140 @@ uint16_t host_crc16(uint16_t crc, uint8_t data) {
 }
 
 static void _i386_init_nvs(const char *fileName) {
-  printf("NVST: Using %s as NVS container\n", fileName);
+  if(nvsPrivate) {
+    _i386_log(LOG_SETUP, "NVST: Using a private NVS container in memory\n");
+    memset(nvsMemory, 0xFF, sizeof(nvsMemory)); // Erased
+    nvs = fmemopen(nvsMemory, sizeof(nvsMemory), "r+b");
+    return;
+  }
+  _i386_log(LOG_SETUP, "NVST: Using %s as NVS container\n", fileName);
   //TODO: create if it didn't already exist
   nvs = fopen(fileName, "r+b");
 }
 
-void _i386_exit_handler(int signum) {
-  printf("SIGINT received, cleaning up and exiting\n");
+static void _i386_init_trace(const char *fileName) {
+  TTraceHeader header;
+
+  if(!(trace = fopen(fileName, "wb"))) {
+    perror(fileName);
+    exit(EXIT_FAILURE);
+  }
+  setvbuf(trace, NULL, _IOFBF, TRACE_BUFFER_SIZE);
+  memset(&header, 0, sizeof(header));
+  strncpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+  header.version = TRACE_VERSION;
+  header.recordSize = sizeof(TTraceRecord);
+  header.fosc = HOST_TIMER_FOSC;
+  fwrite(&header, sizeof(header), 1, trace);
+  _i386_log(LOG_SETUP, "TRCE: Recording binary trace to %s\n", fileName);
+}
+
+static void _i386_trace(uint8_t type, uint8_t id, uint8_t arg, uint32_t value) {
+  TTraceRecord record;
+
+  if(!trace) return;
+  record.cycles = virtualCycles;
+  record.value = value;
+  record.type = type;
+  record.id = id;
+  record.arg = arg;
+  record.reserved = 0;
+  fwrite(&record, sizeof(record), 1, trace);
+}
+
+static void _i386_init_vcd(const char *fileName) {
+  uint8_t i;
+
+  if(!(vcd = fopen(fileName, "w"))) {
+    perror(fileName);
+    exit(EXIT_FAILURE);
+  }
+  setvbuf(vcd, NULL, _IOFBF, TRACE_BUFFER_SIZE);
+  fprintf(vcd, "$version grbl hosting HAL $end\n"
+      "$timescale 1ps $end\n"
+      "$scope module grbl $end\n");
+  for(i = 1; i < sizeof(gpioNames) / sizeof(gpioNames[0]); i++)
+    fprintf(vcd, "$var wire 1 %c %s $end\n", VCD_GPIO_CODE(i), gpioNames[i]);
+  for(i = 0; i < sizeof(timerEvents) / sizeof(timerEvents[0]); i++)
+    fprintf(vcd, "$var event 1 %c T%d_%c_V $end\n",
+        VCD_VECTOR_CODE(timerEvents[i].timer, timerEvents[i].event),
+        timerEvents[i].timer, "OAB"[timerEvents[i].event - EVENT_TIMER_OVERFLOW]);
+  fprintf(vcd, "$upscope $end\n"
+      "$enddefinitions $end\n"
+      "$dumpvars\n");
+  // Outputs are unknown until first written
+  for(i = 1; i < sizeof(gpioNames) / sizeof(gpioNames[0]); i++) {
+    vcdLevels[i] = 'x';
+    fprintf(vcd, "x%c\n", VCD_GPIO_CODE(i));
+  }
+  fprintf(vcd, "$end\n");
+  _i386_log(LOG_SETUP, "TRCE: Recording waveforms to %s\n", fileName);
+}
+
+static void _i386_vcd_time(void) {
+  if(vcdTime != virtualCycles) {
+    vcdTime = virtualCycles;
+    fprintf(vcd, "#%"PRIu64"\n", vcdTime * VCD_PS_PER_CYCLE);
+  }
+}
+
+static void _i386_vcd_gpio(uint8_t output, uint8_t value) {
+  char level = value ? '1' : '0';
+
+  if(!vcd || vcdLevels[output] == level) return;
+  vcdLevels[output] = level;
+  _i386_vcd_time();
+  fprintf(vcd, "%c%c\n", level, VCD_GPIO_CODE(output));
+}
+
+static void _i386_vcd_vector(uint8_t timer, uint8_t event) {
+  if(!vcd) return;
+  _i386_vcd_time();
+  fprintf(vcd, "1%c\n", VCD_VECTOR_CODE(timer, event));
+}
+
+static void _i386_exit(const char *reason) {
+  _i386_log(LOG_SETUP, "%s after %.6fs of simulated time, cleaning up and exiting\n", reason,
+      (double)virtualCycles / HOST_TIMER_FOSC);
 
   if(nvs) fclose(nvs);
+  if(trace) fclose(trace);
+  if(vcd) {
+    _i386_vcd_time(); // So that viewers show the whole run
+    fclose(vcd);
+  }
 
   exit(EXIT_SUCCESS);
 }
 
+void _i386_exit_handler(int signum) {
+  _i386_exit("SIGINT received");
+}
+
 void host_init(int argc, char **argv) {
   struct sigaction sig;
+  const char *traceName = NULL, *vcdName = NULL;
+  int option;
+
+  while((option = getopt(argc, argv, "l:t:w:")) != -1)
+    switch(option) {
+      case 'l':
+        logLevel = atoi(optarg);
+        break;
+      case 't':
+        traceName = optarg;
+        break;
+      case 'w':
+        vcdName = optarg;
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-l log level] [-t trace file] [-w VCD file]\n"
+            "  -l  %d: console only, %d: also setup, %d: also every event (default)\n"
+            "  -t  record a binary trace of every event, see script/trace_decode.py\n"
+            "  -w  record pin and interrupt waveforms as a Value Change Dump\n",
+            argv[0], LOG_QUIET, LOG_SETUP, LOG_TRACE);
+        exit(EXIT_FAILURE);
+    }
 
   sig.sa_handler = _i386_exit_handler;
   sigemptyset(&sig.sa_mask);
@@ -139,128 +284,213 @@ void host_init(int argc, char **argv) {
   sigaction(SIGINT, &sig, NULL);
 
   _i386_init_nvs(NVS_STORE_NAME);
+  if(traceName) _i386_init_trace(traceName);
+  if(vcdName) _i386_init_vcd(vcdName);
 
-  printf("Hosting HAL for grbl up and running, send SIGINT to exit\n");
+  _i386_log(LOG_SETUP, "Hosting HAL for grbl up and running, send SIGINT or EOF to exit\n");
 }
 
 void host_sei(void) {
-  printf("INTR: Interrupts are now globally enabled\n");
+  _i386_log(LOG_TRACE, "INTR: Interrupts are now globally enabled\n");
+  _i386_trace(TRACE_INTERRUPTS, 0, 0, true);
   interruptsEnabled = true;
 }
 
+void host_cli(void) {
+  _i386_log(LOG_TRACE, "INTR: Interrupts are now globally disabled\n");
+  _i386_trace(TRACE_INTERRUPTS, 0, 0, false);
+  interruptsEnabled = false;
+}
+
+/* Grbl is waiting on something, skip ahead to the next interrupt */
+void host_idle(void) {
+  if(interruptsEnabled && eventCount) _i386_do_interrupt_work(eventHeap[0]->due);
+}
+
 static int _i386_compare_interrupts(const void *a, const void *b) {
   return strcmp(((const TInterruptDescriptor *)a)->name,
       ((const TInterruptDescriptor *)b)->name);
 }
 
-static int _i386_compare_timer_events(const void *a, const void *b) {
-  uint32_t av = ((const TTimerEventSpec *)a)->remaining;
-  uint32_t bv = ((const TTimerEventSpec *)b)->remaining;
+/* Earlier due time first, ties go by timer and event so that runs are
+ * repeatable */
+static bool _i386_event_before(const TTimerEventSpec *a, const TTimerEventSpec *b) {
+  return a->due < b->due || (a->due == b->due && a < b);
+}
+
+static void _i386_heap_swap(uint8_t a, uint8_t b) {
+  TTimerEventSpec *tmp = eventHeap[a];
 
-  if(av > bv) return 1;
-  else if(av < bv) return -1;
-  else return 0;
+  eventHeap[a] = eventHeap[b];
+  eventHeap[b] = tmp;
+  eventHeap[a]->slot = a;
+  eventHeap[b]->slot = b;
 }
 
-static bool _i386_advance_timer(uint8_t timer, uint8_t event) {
-  TInterruptDescriptor *intptr;
+static void _i386_heap_up(uint8_t slot) {
+  while(slot && _i386_event_before(eventHeap[slot], eventHeap[(slot - 1) / 2])) {
+    _i386_heap_swap(slot, (slot - 1) / 2);
+    slot = (slot - 1) / 2;
+  }
+}
 
-  intptr = _i386_timer_interrupt_by_type(timer, event);
-  if(intptr && intptr->enabled && intptr->vector) {
-    switch(event) {
-      case EVENT_TIMER_OVERFLOW:
-        timerEvents[timer * sizeof(timers) / sizeof(timers[0]) + event - 1].remaining =
-            timerProperties[timer].compareMax - timers[timer].count;
-        break;
-      case EVENT_TIMER_COMPARE_A:
-        timerEvents[timer * sizeof(timers) / sizeof(timers[0]) + event - 1].remaining =
-            timers[timer].channel[0] - timers[timer].count;
-        break;
-      case EVENT_TIMER_COMPARE_B:
-        timerEvents[timer * sizeof(timers) / sizeof(timers[0]) + event - 1].remaining =
-            timers[timer].channel[1] - timers[timer].count;
-        break;
-    }
-    if(timers[timer].wide)
-      timerEvents[timer * sizeof(timers) / sizeof(timers[0]) + event - 1].remaining &=
-          0xFFFF;
-    else
-      timerEvents[timer * sizeof(timers) / sizeof(timers[0]) + event - 1].remaining &=
-          0xFF;
-    timerEvents[timer * sizeof(timers) / sizeof(timers[0]) + event - 1].remaining *=
-        timers[timer].prescaler;
-    timerEvents[timer * sizeof(timers) / sizeof(timers[0]) + event - 1].vector =
-        intptr->vector;
-    timerEvents[timer * sizeof(timers) / sizeof(timers[0]) + event - 1].timer = timer;
-    timerEvents[timer * sizeof(timers) / sizeof(timers[0]) + event - 1].event = event;
-
-    return true;
-  } else {
-    timerEvents[timer * sizeof(timers) / sizeof(timers[0]) + event - 1].remaining =
-        0xFFFFFFFFUL;
+static void _i386_heap_down(uint8_t slot) {
+  uint8_t child;
 
-    return false;
+  while((child = 2 * slot + 1) < eventCount) {
+    if(child + 1 < eventCount &&
+        _i386_event_before(eventHeap[child + 1], eventHeap[child])) child++;
+    if(!_i386_event_before(eventHeap[child], eventHeap[slot])) break;
+    _i386_heap_swap(slot, child);
+    slot = child;
   }
 }
 
-static bool _i386_update_event_list(void) {
-  bool atLeastOne = false;
-  uint8_t i;
+static void _i386_heap_remove(TTimerEventSpec *spec) {
+  uint8_t slot = spec->slot;
 
-  for(i = 0; i < sizeof(timers) / sizeof(timers[0]); i++)
-    if(timers[i].prescaler) { // Is this one actually running?
-      atLeastOne |= _i386_advance_timer(i, EVENT_TIMER_OVERFLOW);
-      atLeastOne |= _i386_advance_timer(i, EVENT_TIMER_COMPARE_A);
-      atLeastOne |= _i386_advance_timer(i, EVENT_TIMER_COMPARE_B);
-    } else {
-      timerEvents[i * sizeof(timers) / sizeof(timers[0]) + 0].remaining =
-            0xFFFFFFFFUL;
-      timerEvents[i * sizeof(timers) / sizeof(timers[0]) + 1].remaining =
-            0xFFFFFFFFUL;
-      timerEvents[i * sizeof(timers) / sizeof(timers[0]) + 2].remaining =
-            0xFFFFFFFFUL;
-    }
+  if(slot == EVENT_NOT_QUEUED) return;
+  spec->slot = EVENT_NOT_QUEUED;
+  if(slot == --eventCount) return;
+  eventHeap[slot] = eventHeap[eventCount];
+  eventHeap[slot]->slot = slot;
+  _i386_heap_up(slot);
+  _i386_heap_down(eventHeap[slot]->slot);
+}
+
+/* Number of distinct count values before the counter goes back to 0 */
+static uint32_t _i386_timer_top(uint8_t timer) {
+  if(timers[timer].mode == TIMER_MODE_CTC)
+    return (uint32_t)timers[timer].channel[0] + 1;
+  else return timerProperties[timer].compareMax;
+}
+
+/* Brings the count of a timer up to date with the virtual clock */
+static void _i386_timer_sync(uint8_t timer) {
+  TTimerDescriptor *t = &timers[timer];
+  uint32_t top = _i386_timer_top(timer);
+  uint64_t ticks;
 
-  qsort(timerEvents, sizeof(timerEvents) / sizeof(timerEvents[0]),
-      sizeof(timerEvents[0]), _i386_compare_timer_events);
+  if(!t->prescaler) {
+    t->since = virtualCycles;
+    return;
+  }
+  ticks = (virtualCycles - t->since) / t->prescaler;
+  t->since += ticks * t->prescaler;
+  if(t->count >= top) { // Set past TOP in CTC mode, runs on to MAX first
+    if(ticks < timerProperties[timer].compareMax - t->count) {
+      t->count += ticks;
+      return;
+    }
+    ticks -= timerProperties[timer].compareMax - t->count;
+    t->count = 0;
+  }
+  t->count = (t->count + ticks) % top;
+}
+
+/* Virtual cycle the given event of a timer fires at next, EVENT_NEVER if it
+ * doesn't. The timer must be up to date. */
+static uint64_t _i386_timer_due(uint8_t timer, uint8_t event) {
+  TTimerDescriptor *t = &timers[timer];
+  TInterruptDescriptor *intptr = _i386_timer_interrupt_by_type(timer, event);
+  uint32_t top = _i386_timer_top(timer), wrap, match, distance;
+
+  if(!t->prescaler || !intptr || !intptr->enabled || !intptr->vector)
+    return EVENT_NEVER;
+  wrap = (t->count >= top ? timerProperties[timer].compareMax : top);
+  switch(event) {
+    case EVENT_TIMER_OVERFLOW:
+      if(wrap < timerProperties[timer].compareMax) return EVENT_NEVER;
+      distance = wrap - t->count;
+      break;
+    case EVENT_TIMER_COMPARE_A:
+    case EVENT_TIMER_COMPARE_B:
+      match = t->channel[event - EVENT_TIMER_COMPARE_A];
+      if(match >= wrap) return EVENT_NEVER;
+      distance = (match >= t->count ? match - t->count : wrap - t->count + match);
+      // Counter is there already, the match was when it got there
+      if(!distance) distance = top;
+      break;
+    default:
+      return EVENT_NEVER;
+  }
 
-  return atLeastOne;
+  return t->since + (uint64_t)distance * t->prescaler;
 }
 
-static void _i386_do_interrupt_work(void) {
-  //NOTE: stdin is line-buffered, even if we read it via fgetc(), so it makes
-  //      sense to loop until all timer interrupt work has been exhausted and
-  //      only then return to the code. This also makes things like counting
-  //      GPIO pulses easier.
-  //TODO: if we ever want to debug the planner, we would need a means to allow
-  //      the move buffer to become full and only *then* start issuing
-  //      interrupts.
-  while(_i386_update_event_list()) {
-    printf("CTTM: %s condition on timer %d, executing interrupt vector\n",
-    timerInterruptNames[timerEvents[0].event], timerEvents[0].timer);
-    switch(timerEvents[0].event) {
+static void _i386_schedule_event(uint8_t timer, uint8_t event) {
+  TTimerEventSpec *spec = _i386_timer_event(timer, event);
+  TInterruptDescriptor *intptr;
+
+  spec->due = _i386_timer_due(timer, event);
+  if(spec->due == EVENT_NEVER) {
+    _i386_heap_remove(spec);
+    return;
+  }
+  intptr = _i386_timer_interrupt_by_type(timer, event);
+  spec->vector = intptr->vector;
+  if(spec->slot == EVENT_NOT_QUEUED) {
+    spec->slot = eventCount;
+    eventHeap[eventCount++] = spec;
+  }
+  _i386_heap_up(spec->slot);
+  _i386_heap_down(spec->slot);
+}
+
+/* Reschedules all events of one timer, after it fired or its setup changed */
+static void _i386_rearm_timer(uint8_t timer) {
+  _i386_timer_sync(timer);
+  _i386_schedule_event(timer, EVENT_TIMER_OVERFLOW);
+  _i386_schedule_event(timer, EVENT_TIMER_COMPARE_A);
+  _i386_schedule_event(timer, EVENT_TIMER_COMPARE_B);
+}
+
+/* Dispatches timer interrupts in order, up to and including those due at
+ * virtual cycle until. Returns true if there were any. */
+static bool _i386_do_interrupt_work(uint64_t until) {
+  TTimerEventSpec *next;
+  uint8_t timer;
+  bool worked = false;
+
+  while(eventCount && eventHeap[0]->due <= until) {
+    next = eventHeap[0];
+    timer = next->timer;
+    _i386_log(LOG_TRACE, "CTTM: %s condition on timer %d, executing interrupt vector\n",
+    timerInterruptNames[next->event], timer);
+    // Events that fell due while interrupts were disabled are dispatched late,
+    // the clock never runs backwards
+    if(virtualCycles < next->due) virtualCycles = next->due;
+    _i386_trace(TRACE_VECTOR_ENTER, timer, next->event, 0);
+    _i386_vcd_vector(timer, next->event);
+    timers[timer].since = virtualCycles;
+    switch(next->event) {
       case EVENT_TIMER_OVERFLOW:
-        // The interrupt alone takes 4 cycles which means that, in the worst
-        // case, the timer value you were interrupted for will be at least 4
-        // units behind you when you enter the ISR.
-        timers[timerEvents[0].timer].count = 0 + 1;
+        timers[timer].count = 0;
         break;
       case EVENT_TIMER_COMPARE_A:
-        timers[timerEvents[0].timer].count =
-            timers[timerEvents[0].timer].channel[0] + 1;
+        // Clear Timer on Compare, same as i386_timer_set_reload() assumes
+        if(timers[timer].mode == TIMER_MODE_CTC) timers[timer].count = 0;
+        else timers[timer].count = timers[timer].channel[0];
         break;
       case EVENT_TIMER_COMPARE_B:
-        timers[timerEvents[0].timer].count =
-            timers[timerEvents[0].timer].channel[1] + 1;
+        timers[timer].count = timers[timer].channel[1];
         break;
     }
-    interruptsEnabled = false;
-    printf("INTR: Interrupts are now globally disabled\n");
-    timerEvents[0].vector();
-    printf("CTTM: return from %s condition interrupt vector of timer %d\n",
-        timerInterruptNames[timerEvents[0].event], timerEvents[0].timer);
+    // Only the timer that fired needs rearming, anything the vector changes
+    // rearms the timers it touches
+    _i386_rearm_timer(timer);
+    host_cli();
+    timers[timer].lastInterrupt = virtualCycles;
+    next->vector();
+    _i386_log(LOG_TRACE, "CTTM: return from %s condition interrupt vector of timer %d\n",
+        timerInterruptNames[next->event], timer);
+    _i386_trace(TRACE_VECTOR_EXIT, timer, next->event, 0);
+    if(interruptHook) interruptHook(timer, next->event);
     host_sei();
+    worked = true;
   }
+
+  return worked;
 }
 
 static TInterruptDescriptor *_i386_interrupt_by_name(const char *name) {
@@ -279,58 +509,69 @@ void i386_register_interrupt(const char *name, void(*isr)(void)) {
 
   if(tmpintptr) {
     tmpintptr->vector = isr;
-    printf("INTR: Associated code at %p with vector %s\n", isr, name);
+    _i386_log(LOG_SETUP, "INTR: Associated code at %p with vector %s\n", isr, name);
+    if(name[0] == 'T') _i386_rearm_timer(name[1] - '0');
   }
 }
 
 void host_gpio_write(uint8_t output, uint8_t value, bool mode) {
-  if(mode == HOST_GPIO_MODE_BIT)
-    printf("GPIO: Output %s set %s\n", gpioNames[output],
+  if(mode == HOST_GPIO_MODE_BIT) {
+    _i386_log(LOG_TRACE, "GPIO: Output %s set %s\n", gpioNames[output],
         (value ? "HIGH" : "LOW"));
+    _i386_trace(TRACE_GPIO_WRITE, output, 0, value ? 1 : 0);
+    _i386_vcd_gpio(output, value);
+  }
 }
 
 void host_gpio_direction(uint8_t output, bool direction, bool mode) {
-  if(mode == HOST_GPIO_MODE_BIT)
-    printf("GPIO: %s configured as %s\n", gpioNames[output],
+  if(mode == HOST_GPIO_MODE_BIT) {
+    _i386_log(LOG_SETUP, "GPIO: %s configured as %s\n", gpioNames[output],
         ((direction == HOST_GPIO_DIRECTION_INPUT) ? "INPUT" : "OUTPUT"));
+    _i386_trace(TRACE_GPIO_DIRECTION, output, 0, direction);
+  }
 }
 
 uint8_t host_gpio_read(uint8_t output, bool mode) {
-  printf("GPIO: Reads not implemented yet, returning HIGH\n");
+  _i386_log(LOG_TRACE, "GPIO: Reads not implemented yet, returning HIGH\n");
 
   return ((mode == HOST_GPIO_MODE_BIT) ? true : 0xFF);
 }
 
 static void _i386_nvs_write(const void *data, size_t size, long int offset) {
+  if(!nvs) return; // No container, nothing persists
   fseek(nvs, offset, SEEK_SET);
   fwrite(data, size, 1, nvs);
   fflush(nvs);
 }
 
 static void _i386_nvs_read(void *data, size_t size, long int offset) {
+  if(!nvs) {
+    memset(data, 0xFF, size); // Erased EEPROM reads back all ones
+    return;
+  }
   fseek(nvs, offset, SEEK_SET);
   fread(data, size, 1, nvs);
 }
 
 void host_nvs_store_byte(uint8_t *address, const uint8_t value) {
-  printf("NVST: Storing %"PRIX8"@0x%04"PRIX16"\n", value, (uint16_t)(ptrdiff_t)address);
+  _i386_log(LOG_SETUP, "NVST: Storing %"PRIX8"@0x%04"PRIX16"\n", value, (uint16_t)(ptrdiff_t)address);
   _i386_nvs_write(&value, sizeof(value), (long int)(ptrdiff_t)address);
 }
 
 void host_nvs_store_word(uint16_t *address, const uint16_t value) {
-  printf("NVST: Storing %"PRIX16"@0x%04"PRIX16"\n", value, (uint16_t)(ptrdiff_t)address);
+  _i386_log(LOG_SETUP, "NVST: Storing %"PRIX16"@0x%04"PRIX16"\n", value, (uint16_t)(ptrdiff_t)address);
   _i386_nvs_write(&value, sizeof(value), (long int)(ptrdiff_t)address);
 }
 
 void host_nvs_store_data(uint8_t *address, const void *value, size_t size){
-  printf("NVST: Storing %zu bytes of data at 0x%04"PRIX16"\n", size, (uint16_t)(ptrdiff_t)address);
+  _i386_log(LOG_SETUP, "NVST: Storing %zu bytes of data at 0x%04"PRIX16"\n", size, (uint16_t)(ptrdiff_t)address);
   _i386_nvs_write(value, size, (long int)(ptrdiff_t)address);
 }
 
 uint8_t host_nvs_fetch_byte(uint8_t *address) {
   uint8_t buf;
 
-  printf("NVST: Fetching a byte from 0x%04"PRIX16"\n", (uint16_t)(ptrdiff_t)address);
+  _i386_log(LOG_SETUP, "NVST: Fetching a byte from 0x%04"PRIX16"\n", (uint16_t)(ptrdiff_t)address);
   _i386_nvs_read(&buf, sizeof(buf), (long int)(ptrdiff_t)address);
 
   return buf;
@@ -339,33 +580,75 @@ uint8_t host_nvs_fetch_byte(uint8_t *address) {
 uint16_t host_nvs_fetch_word(uint16_t *address) {
   uint16_t buf;
 
-  printf("NVST: Fetching a word from 0x%04"PRIX16"\n", (uint16_t)(ptrdiff_t)address);
+  _i386_log(LOG_SETUP, "NVST: Fetching a word from 0x%04"PRIX16"\n", (uint16_t)(ptrdiff_t)address);
   _i386_nvs_read(&buf, sizeof(buf), (long int)(ptrdiff_t)address);
 
   return buf;
 }
 
 void host_nvs_fetch_data(uint8_t *address, void *buffer, size_t size) {
-  printf("NVST: Fetching %zu bytes of data from 0x%04"PRIX16"\n", size, (uint16_t)(ptrdiff_t)address);
+  _i386_log(LOG_SETUP, "NVST: Fetching %zu bytes of data from 0x%04"PRIX16"\n", size, (uint16_t)(ptrdiff_t)address);
   _i386_nvs_read(buffer, size, (long int)(ptrdiff_t)address);
 }
 
 void host_serialconsole_init() {
-  printf("SCON: Serial console up and running\n");
+  _i386_log(LOG_SETUP, "SCON: Serial console up and running\n");
 }
 
 void host_serialconsole_reset() {
-  printf("SCON: Serial console Rx buffer scrapped\n");
+  _i386_log(LOG_SETUP, "SCON: Serial console Rx buffer scrapped\n");
 }
 
-char host_serialconsole_read(void) {
-  //This is an input-driven program, it therefore makes sense to trap the
-  //look-alike of the read() call and schedule interrupt work there
-  if(interruptsEnabled) _i386_do_interrupt_work();
+void host_serialconsole_set_filter(THostSerialConsoleFilter filter) {
+  serialconsoleFilter = filter;
+}
 
-  int c = fgetc(stdin);
+/* Counts the bytes that came in by now */
+static void _i386_rx_update(void) {
+  while(rxHeld < CONSOLE_RXBUF_SIZE - 1 && rxArrival <= virtualCycles) {
+    rxHeld++;
+    rxArrival += CONSOLE_CHAR_CYCLES;
+  }
+}
 
-  return (c == EOF ? CONSOLE_NO_DATA : c);
+/* Takes the next byte off the line, waiting for it to come in if need be */
+static void _i386_rx_next(void) {
+  _i386_rx_update();
+  if(!rxHeld) {
+    if(interruptsEnabled) _i386_do_interrupt_work(rxArrival);
+    if(virtualCycles < rxArrival) virtualCycles = rxArrival;
+    _i386_rx_update();
+  }
+  // The ring was full and the host waiting for room, it sends on right away
+  if(rxArrival <= virtualCycles) rxArrival = virtualCycles + CONSOLE_CHAR_CYCLES;
+  rxHeld--;
+}
+
+uint16_t host_serialconsole_rx_free(void) {
+  if(rxEOF) return CONSOLE_RXBUF_SIZE - 1;
+  _i386_rx_update();
+
+  return CONSOLE_RXBUF_SIZE - 1 - rxHeld;
+}
+
+int host_serialconsole_read(void) {
+  int c;
+
+  //No Rx interrupt, so apply the filter as bytes come in
+  do {
+    if((c = fgetc(stdin)) == EOF) break;
+    _i386_rx_next();
+  } while(serialconsoleFilter && serialconsoleFilter(c));
+
+  if(c == EOF) {
+    rxEOF = true;
+    //Out of input with no interrupt left to come means grbl has nothing left
+    //to do but wait for input that will never come
+    if(!interruptsEnabled || !eventCount) _i386_exit("EOF on console");
+    return CONSOLE_NO_DATA;
+  }
+
+  return c;
 }
 
 bool host_serialconsole_write(char c, bool block) {
@@ -428,7 +711,9 @@ void i386_timer_enable_interrupt(uint8_t timer, uint8_t which) {
   tmpintptr = _i386_timer_interrupt_by_type(timer, which);
   if(tmpintptr) {
     tmpintptr->enabled = true;
-    printf("INTR: Enabled interrupt for timer %"PRIu8" event %s\n", timer, timerInterruptNames[which]);
+    _i386_log(LOG_TRACE, "INTR: Enabled interrupt for timer %"PRIu8" event %s\n", timer, timerInterruptNames[which]);
+    _i386_trace(TRACE_INTERRUPT_ENABLE, timer, which, true);
+    _i386_rearm_timer(timer);
   }
 }
 
@@ -438,34 +723,48 @@ void i386_timer_disable_interrupt(uint8_t timer, uint8_t which) {
   tmpintptr = _i386_timer_interrupt_by_type(timer, which);
   if(tmpintptr) {
     tmpintptr->enabled = false;
-    printf("INTR: Disabled interrupt for timer %"PRIu8" event %s\n", timer, timerInterruptNames[which]);
+    _i386_log(LOG_TRACE, "INTR: Disabled interrupt for timer %"PRIu8" event %s\n", timer, timerInterruptNames[which]);
+    _i386_trace(TRACE_INTERRUPT_ENABLE, timer, which, false);
+    _i386_rearm_timer(timer);
   }
 }
 
 void host_timer_set_compare(uint8_t timer, uint8_t channel, uint32_t value) {
   if(timers[timer].wide) value &= 0xFFFF; // Wrap around
   else value &= 0xFF;
+  _i386_timer_sync(timer);
   timers[timer].channel[channel - HOST_TIMER_CHANNEL_A] = value;
-  printf("CTTM: Set counter/timer %"PRIu8" %s value to %"PRIu32"\n", timer, timerInterruptNames[channel], value);
+  _i386_log(LOG_TRACE, "CTTM: Set counter/timer %"PRIu8" %s value to %"PRIu32"\n", timer, timerInterruptNames[channel], value);
+  _i386_trace(TRACE_TIMER_COMPARE, timer, channel, value);
+  _i386_rearm_timer(timer);
 }
 
 void host_timer_set_count(uint8_t timer, uint32_t count) {
   if(timers[timer].wide) count &= 0xFFFF; // Wrap around
   else count &= 0xFF;
+  _i386_timer_sync(timer);
   timers[timer].count = count;
-  printf("CTTM: Set counter/timer %"PRIu8" count value to %"PRIu32"\n", timer, count);
+  _i386_log(LOG_TRACE, "CTTM: Set counter/timer %"PRIu8" count value to %"PRIu32"\n", timer, count);
+  _i386_trace(TRACE_TIMER_COUNT, timer, 0, count);
+  _i386_rearm_timer(timer);
 }
 
-void host_timer_set_prescaler(uint8_t timer, uint8_t prescaler) {
+void host_timer_set_prescaler(uint8_t timer, uint16_t prescaler) {
+  _i386_timer_sync(timer);
   timers[timer].prescaler = prescaler;
   if(prescaler)
-    printf("CTTM: Set counter/timer %"PRIu8" divisor to %"PRIu8" resulting in %luHz clock\n", timer, prescaler, HOST_TIMER_FOSC / prescaler);
-  else printf("CTTM: Set counter/timer %"PRIu8" to no prescaler (i.e. stopped)\n", timer);
+    _i386_log(LOG_TRACE, "CTTM: Set counter/timer %"PRIu8" divisor to %"PRIu16" resulting in %luHz clock\n", timer, prescaler, HOST_TIMER_FOSC / prescaler);
+  else _i386_log(LOG_TRACE, "CTTM: Set counter/timer %"PRIu8" to no prescaler (i.e. stopped)\n", timer);
+  _i386_trace(TRACE_TIMER_PRESCALER, timer, 0, prescaler);
+  _i386_rearm_timer(timer);
 }
 
 void host_timer_enable_ctc(uint8_t timer) {
+  _i386_timer_sync(timer);
   timers[timer].mode = TIMER_MODE_CTC;
-  printf("CTTM: Set counter/timer %"PRIu8" operation mode to CTC\n", timer);
+  _i386_log(LOG_TRACE, "CTTM: Set counter/timer %"PRIu8" operation mode to CTC\n", timer);
+  _i386_trace(TRACE_TIMER_CTC, timer, 0, 0);
+  _i386_rearm_timer(timer);
 }
 
 uint32_t i386_timer_set_reload(uint8_t timer, uint32_t cycles) {
@@ -488,12 +787,45 @@ uint32_t i386_timer_set_reload(uint8_t timer, uint32_t cycles) {
   return (timerProperties[timer].compareMax - 1) * timerProperties[timer].pDivisors[i];
 }
 
+uint32_t i386_timer_get_elapsed_cycles(uint8_t timer) {
+  return virtualCycles - timers[timer].lastInterrupt;
+}
+
+bool i386_timer_interrupt_pending(uint8_t timer, uint8_t which) {
+  const TTimerEventSpec *spec;
+
+  if(which < EVENT_TIMER_OVERFLOW || which > EVENT_TIMER_COMPARE_B)
+    return false;
+  spec = _i386_timer_event(timer, which);
+
+  return spec->slot != EVENT_NOT_QUEUED && spec->due <= virtualCycles;
+}
+
+uint64_t i386_virtual_cycles(void) {
+  return virtualCycles;
+}
+
+void i386_set_interrupt_hook(THostInterruptHook hook) {
+  interruptHook = hook;
+}
+
+void i386_set_log_level(uint8_t level) {
+  logLevel = level;
+}
+
+void i386_set_private_nvs(void) {
+  nvsPrivate = true;
+}
+
 //TODO: maybe, in the future, check timer contention when used as FG
 void host_functiongenerator_start(uint8_t output, uint32_t frequency, uint8_t form) {
-  if(form == HOST_FG_SQUARE)
-    printf("GPIO: Output %s configured for WGM, square-wave, 50%%, %"PRIu32"Hz\n", gpioNames[output], frequency);
+  if(form == HOST_FG_SQUARE) {
+    _i386_log(LOG_SETUP, "GPIO: Output %s configured for WGM, square-wave, 50%%, %"PRIu32"Hz\n", gpioNames[output], frequency);
+    _i386_trace(TRACE_FG_START, output, form, frequency);
+  }
 }
 
 void host_functiongenerator_stop(uint8_t output) {
-  printf("GPIO: Output %s WGM configuration disabled\n", gpioNames[output]);
+  _i386_log(LOG_SETUP, "GPIO: Output %s WGM configuration disabled\n", gpioNames[output]);
+  _i386_trace(TRACE_FG_STOP, output, 0, 0);
 }
@@ -43,6 +43,11 @@ void host_init(int argc, char **argv); // Set environment up when hosting
 
 /* Host-specific interrupt enable */
 void host_sei(void);
+/* Host-specific interrupt disable */
+void host_cli(void);
+/* Host-specific idle hook, called where the main program waits on interrupts.
+ * There are none on the host, so this dispatches all timer interrupt work. */
+void host_idle(void);
 /* Host-specific interrupt vector declaration */
 #define HOST_INTERRUPT(x) void x(void);\
   void x(void)
@@ -52,7 +57,7 @@ void host_sei(void);
 void i386_register_interrupt(const char *name, void(*isr)(void));
 #define host_register_interrupt(vector) i386_register_interrupt(_i386_stringify(vector), vector)
 
-/* Host-specific delays */
+/* Host-specific delays, these advance the simulated CPU clock */
 void i386_delay_us(uint32_t us);
 #define host_delay_ms(ms) i386_delay_us(ms * 1000UL)
 #define host_delay_us(us) i386_delay_us(us)
@@ -63,6 +68,10 @@ void i386_delay_us(uint32_t us);
 #define _S_t(s) s
 /* ... (access method) */
 #define host_fetch_S(s) *(s)
+/* Host-specific constant table treatment (type) */
+#define _T_t(t) t
+/* ... (access method for 16-bit entries) */
+#define host_fetch_W(w) *(w)
 
 /* Host-specific NVS methods */
 void host_nvs_store_byte(uint8_t *address, uint8_t value);
@@ -79,8 +88,8 @@ uint16_t host_crc16(uint16_t crc, uint8_t data);
 /* Serial console interface */
 void host_serialconsole_init();
 void host_serialconsole_reset();
-/* Returns CONSOLE_NO_DATA if nothing to read */
-char host_serialconsole_read(void);
+/* Returns the next received byte, or CONSOLE_NO_DATA if nothing to read */
+int host_serialconsole_read(void);
 bool host_serialconsole_write(char c, bool block);
 bool host_serialconsole_printinteger(uint32_t n, bool block);
 bool host_serialconsole_printbinary(uint8_t n, bool block);
@@ -139,14 +148,35 @@ void i386_timer_disable_interrupt(uint8_t timer, uint8_t which);
 #define host_timer_enable_interrupt(timer,which) _host_timer_enable_interrupt(timer,__i386_if_of_timer(which))
 #define _host_timer_disable_interrupt(timer,which) i386_timer_disable_interrupt(timer, which)
 #define host_timer_disable_interrupt(timer,which) _host_timer_disable_interrupt(timer,__i386_if_of_timer(which))
+bool i386_timer_interrupt_pending(uint8_t timer, uint8_t which);
+#define _host_timer_interrupt_pending(timer,which) i386_timer_interrupt_pending(timer, which)
+#define host_timer_interrupt_pending(timer,which) _host_timer_interrupt_pending(timer,__i386_if_of_timer(which))
 void host_timer_set_compare(uint8_t timer, uint8_t channel, uint32_t value);
 #define host_prescaler_of_divisor(timer,divisor) (divisor)
 void host_timer_set_count(uint8_t timer, uint32_t count);
-void host_timer_set_prescaler(uint8_t timer, uint8_t prescaler);
+void host_timer_set_prescaler(uint8_t timer, uint16_t prescaler);
 void host_timer_enable_ctc(uint8_t timer);
 uint32_t i386_timer_set_reload(uint8_t timer, uint32_t cycles);
 #define host_timer_set_reload(timer,cycles,actual_cycles) \
   actual_cycles = i386_timer_set_reload(timer, cycles)
+/* Cycles of the simulated CPU clock elapsed since the last interrupt of the
+ * given timer was dispatched. Vectors take no simulated time to run, so this
+ * is only non-zero outside of them (e.g. after a delay). */
+uint32_t i386_timer_get_elapsed_cycles(uint8_t timer);
+#define host_timer_get_elapsed_cycles(timer) i386_timer_get_elapsed_cycles(timer)
+
+/* Simulation interface, for programs that embed grbl (see sim/) */
+/* Simulated CPU clock, in HOST_TIMER_FOSC cycles since startup */
+uint64_t i386_virtual_cycles(void);
+/* Called after each timer interrupt vector returns, NULL to remove */
+typedef void (*THostInterruptHook)(uint8_t timer, uint8_t which);
+void i386_set_interrupt_hook(THostInterruptHook hook);
+/* Same as -l on the command line, call before host_init() to take effect
+ * there too */
+void i386_set_log_level(uint8_t level);
+/* Keeps NVS in memory, starting out erased, instead of in the container file
+ * shared by all runs. Call before host_init(). */
+void i386_set_private_nvs(void);
 
 /* Host waveform generator interface */
 void host_functiongenerator_start(uint8_t output, uint32_t frequency, uint8_t form);
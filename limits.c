@@ -149,7 +149,7 @@ static void leave_limit_switch(bool x, bool y, bool z) {
 }
 
 void limits_go_home() {
-  plan_synchronize();
+  mc_synchronize();
   approach_limit_switch(false, false, true); // First home the z axis
   approach_limit_switch(true, true, false);  // Then home the x and y axes
   // Now carefully leave the limit switches
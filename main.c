@@ -30,6 +30,7 @@
 #include "cpump.h"
 #include "gcode.h"
 #include "limits.h"
+#include "motion_control.h"
 #include "nuts_bolts.h"
 #include "planner.h"
 #include "protocol.h"
@@ -70,6 +71,7 @@ int main(int argc, char **argv) {
       // back to [0,0,0] if an abort is used while grbl is moving the machine.
       int32_t last_position[3];
       float last_coord_system[N_COORDINATE_SYSTEM][3];
+      bool last_opt_stop = sys.opt_stop;
       memcpy(last_position, sys.position, sizeof(sys.position)); // last_position[] = sys.position[]
       memcpy(last_coord_system, sys.coord_system, sizeof(sys.coord_system)); // last_coord_system[] = sys.coord_system[]
 
@@ -79,6 +81,7 @@ int main(int argc, char **argv) {
       settings_init(); // Load grbl settings from EEPROM
       protocol_init(); // Clear incoming line data
       plan_init(); // Clear block buffer and planner variables
+      mc_init(); // Clear motion queue
       gc_init(); // Set g-code parser to default state
       #ifdef CHARGE_PUMP
         cpump_init(); // Fire up Charge Pump to wake up servo controller as following calls may try to move things
@@ -91,6 +94,7 @@ int main(int argc, char **argv) {
       // Reload last known machine position and work systems. G92 coordinate offsets are reset.
       memcpy(sys.position, last_position, sizeof(last_position)); // sys.position[] = last_position[]
       memcpy(sys.coord_system, last_coord_system, sizeof(last_coord_system)); // sys.coord_system[] = last_coord_system[]
+      sys.opt_stop = last_opt_stop;
       gc_set_current_position(last_position[X_AXIS], last_position[Y_AXIS], last_position[Z_AXIS]);
       plan_set_current_position(last_position[X_AXIS], last_position[Y_AXIS], last_position[Z_AXIS]);
 
@@ -23,9 +23,12 @@
 #include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "config.h"
 
+#include "motion_control.h"
+
 #include "limits.h"
 #include "nuts_bolts.h"
 #include "planner.h"
@@ -34,25 +37,51 @@
 #include "stepper.h"
 
 
-// Execute linear motion in absolute millimeter coordinates. Feed rate given in
-// millimeters/second unless invert_feed_rate is true. Then the feed_rate means
-// that the motion should be completed in (1 minute)/feed_rate time.
-// NOTE: This is the primary gateway to the grbl planner. All line motions,
-//       including arc line segments, must pass through this routine before
-//       being passed to the planner. The separation of mc_line and
-//       plan_buffer_line is done primarily to make backlash compensation
-//       integration simple and direct.
+// State of the arc generator, kept with every queued arc so the next one can be set up while the
+// previous one is still going into the plan.
+typedef struct {
+  float center_axis0, center_axis1; // Circle center
+  float r_axis0, r_axis1; // Radius vector from center to the last segment's end
+  float offset_axis0, offset_axis1; // Offset from start to center, for arc correction
+  float linear_axis; // Helical travel so far
+  float linear_per_segment;
+  float theta_per_segment;
+  float cos_T, sin_T; // Vector rotation matrix values
+  uint16_t segment; // The next segment
+  uint16_t segments;
+  uint8_t axis_0, axis_1, axis_linear;
+  int8_t count; // Segments since the last arc correction
+} arc_t;
+
+// A parsed motion, waiting for room in the plan. An arc is generated segment by segment from its
+// arc state, as room frees up, and only leaves the queue after its last segment. A pause holds up
+// everything behind it until the plan has run out, then turns auto start off.
+#define MOTION_LINE 0
+#define MOTION_ARC 1
+#define MOTION_PAUSE 2
+typedef struct {
+  float x, y, z; // Target
+  float feed_rate;
+  bool invert_feed_rate;
+  uint8_t type;
+  union {
+    arc_t arc; // MOTION_ARC only
+    bool optional; // MOTION_PAUSE only: M1, pauses only if the optional stop switch is on by then
+  } data;
+} motion_t;
+
+static motion_t queue[MOTION_QUEUE_SIZE]; // A ring buffer of motions bound for the planner
+static uint8_t queue_head; // Index of the next free slot
+static uint8_t queue_tail; // Index of the oldest queued motion
+static uint8_t queue_count;
+
+
+// Hands one line to the planner. This is the primary gateway to the grbl planner, all line
+// motions, including arc line segments, pass through here.
 // NOTE: There will be no backlash compensation, the hardware we're targeting
 //       has, by definition, no backlash (it's impossible to go further and
 //       then backward when taking an inside cut, for example)
-void mc_line(float x, float y, float z, float feed_rate, bool invert_feed_rate) {
-  // If the buffer is full: good! That means we are well ahead of the robot. 
-  // Remain in this loop until there is room in the buffer.
-  do {
-    execute_runtime(); // Check for any run-time commands
-    if(sys.abort) return; // Bail, if system abort.
-  } while (plan_check_full_buffer());
-
+static void buffer_line(float x, float y, float z, float feed_rate, bool invert_feed_rate) {
   #ifdef LIMIT_SOFT
     // Clip the move if it falls outside our physical extents
     if(LIMIT_X_NEG_TYPE == LIMIT_TYPE_SOFT && x < LIMIT_X_NEG_VALUE)
@@ -70,7 +99,117 @@ void mc_line(float x, float y, float z, float feed_rate, bool invert_feed_rate)
   #endif
 
   plan_buffer_line(x, y, z, feed_rate, invert_feed_rate);
-  
+}
+
+// Hands the next segment of the queued arc, ending at target, to the planner. Returns true after
+// the last one.
+static bool arc_next_segment(motion_t *target) {
+  arc_t *arc = &target->data.arc;
+  float arc_target[3];
+  float sin_Ti;
+  float cos_Ti;
+  float r_axisi;
+
+  if(arc->segment >= arc->segments) { // Ensure last segment arrives at target location.
+    buffer_line(target->x, target->y, target->z, target->feed_rate, target->invert_feed_rate);
+    return true;
+  }
+
+  if(arc->count < N_ARC_CORRECTION) {
+    // Apply vector rotation matrix
+    r_axisi = arc->r_axis0*arc->sin_T + arc->r_axis1*arc->cos_T;
+    arc->r_axis0 = arc->r_axis0*arc->cos_T - arc->r_axis1*arc->sin_T;
+    arc->r_axis1 = r_axisi;
+    arc->count++;
+  } else {
+    // Arc correction to radius vector. Computed only every N_ARC_CORRECTION increments.
+    // Compute exact location by applying transformation matrix from initial radius vector(=-offset).
+    cos_Ti = cos(arc->segment*arc->theta_per_segment);
+    sin_Ti = sin(arc->segment*arc->theta_per_segment);
+    arc->r_axis0 = -arc->offset_axis0 * cos_Ti + arc->offset_axis1 * sin_Ti;
+    arc->r_axis1 = -arc->offset_axis0 * sin_Ti - arc->offset_axis1 * cos_Ti;
+    arc->count = 0;
+  }
+  arc->segment++;
+
+  // Update arc_target location
+  arc_target[arc->axis_0] = arc->center_axis0 + arc->r_axis0;
+  arc_target[arc->axis_1] = arc->center_axis1 + arc->r_axis1;
+  arc->linear_axis += arc->linear_per_segment;
+  arc_target[arc->axis_linear] = arc->linear_axis;
+  buffer_line(arc_target[X_AXIS], arc_target[Y_AXIS], arc_target[Z_AXIS], target->feed_rate,
+      target->invert_feed_rate);
+
+  return false;
+}
+
+// Waits for a free slot in the queue and returns it, NULL on system abort.
+static motion_t *queue_next() {
+  // If the queue is full too: good! That means we are well ahead of the robot.
+  // Remain in this loop until there is room in the queue.
+  while(queue_count == MOTION_QUEUE_SIZE) {
+    execute_runtime(); // Check for any run-time commands
+    if(sys.abort) return NULL; // Bail, if system abort.
+    mc_pump();
+  }
+
+  return &queue[queue_head];
+}
+
+// Adds the motion returned by queue_next() to the queue.
+static void queue_push(float x, float y, float z, float feed_rate, bool invert_feed_rate,
+    uint8_t type) {
+  motion_t *motion = &queue[queue_head];
+
+  motion->x = x;
+  motion->y = y;
+  motion->z = z;
+  motion->feed_rate = feed_rate;
+  motion->invert_feed_rate = invert_feed_rate;
+  motion->type = type;
+  if(++queue_head == MOTION_QUEUE_SIZE) queue_head = 0;
+  queue_count++;
+
+  // Straight on to the planner, if it has room. Otherwise protocol will hand
+  // it over as soon as it does, reading and parsing on in the meantime.
+  mc_pump();
+}
+
+// Execute linear motion in absolute millimeter coordinates. Feed rate given in
+// millimeters/second unless invert_feed_rate is true. Then the feed_rate means
+// that the motion should be completed in (1 minute)/feed_rate time.
+void mc_line(float x, float y, float z, float feed_rate, bool invert_feed_rate) {
+  if(!queue_next()) return;
+  queue_push(x, y, z, feed_rate, invert_feed_rate, MOTION_LINE);
+}
+
+// Moves queued motions to the planner, for as long as it has room. Arcs go in one segment per
+// free block.
+void mc_pump() {
+  motion_t *motion;
+  bool pausing = false;
+
+  if(!queue_count) return;
+  while(queue_count && !plan_check_full_buffer()) {
+    motion = &queue[queue_tail];
+    if(motion->type == MOTION_ARC) {
+      if(!arc_next_segment(motion)) continue;
+    } else if(motion->type == MOTION_PAUSE) {
+      // Checked as late as possible, '$O' may have been toggled since M1 was parsed
+      if(!motion->data.optional || sys.opt_stop) {
+        pausing = plan_get_current_block() || sys.cycle_start;
+        if(pausing) break; // Not there yet
+        sys.auto_start = false; // Disable auto cycle start, what follows waits for cycle start
+      }
+    } else buffer_line(motion->x, motion->y, motion->z, motion->feed_rate,
+        motion->invert_feed_rate);
+    if(++queue_tail == MOTION_QUEUE_SIZE) queue_tail = 0;
+    queue_count--;
+  }
+  #ifdef PLANNER_TELEMETRY
+    plan_telemetry_pausing(pausing); // The buffer is meant to run dry then
+  #endif
+
   // Auto-cycle start immediately after planner finishes. Enabled/disabled by
   // grbl settings. During a feed hold, auto-start is disabled momentarily until
   // the cycle is resumed by the cycle-start runtime command.
@@ -84,12 +223,28 @@ void mc_line(float x, float y, float z, float feed_rate, bool invert_feed_rate)
   if(sys.auto_start) st_cycle_start();
 }
 
+// Block until all queued and buffered motions are executed.
+void mc_synchronize() {
+  while(queue_count) {
+    execute_runtime();
+    if(sys.abort) return;
+    mc_pump();
+  }
+  plan_synchronize();
+}
+
+// Empties the queue, whatever is in it is lost
+void mc_init() {
+  queue_head = queue_tail = queue_count = 0;
+}
+
 // Execute an arc in offset mode format. position == current xyz, target == target xyz, 
 // offset == offset from current xyz, axis_XXX defines circle plane in tool space, axis_linear is
 // the direction of helical travel, radius == circle radius, isclockwise boolean. Used
 // for vector transformation direction.
 // The arc is approximated by generating a huge number of tiny, linear segments. The length of each 
-// segment is configured in settings.mm_per_arc_segment.  
+// segment is configured in settings.mm_per_arc_segment. Only the set up is done here, segments are
+// generated by mc_pump() as the planner frees up room.
 void mc_arc(float *position, float *target, float *offset, uint8_t axis_0,
     uint8_t axis_1, uint8_t axis_linear, float feed_rate, bool invert_feed_rate,
     float radius, bool isclockwise) {
@@ -115,9 +270,15 @@ void mc_arc(float *position, float *target, float *offset, uint8_t axis_0,
   // by a number of discrete segments. The inverse feed_rate should be correct for the sum of 
   // all segments.
   if(invert_feed_rate) feed_rate *= segments;
+
+  motion_t *motion = queue_next();
+  arc_t *arc;
+
+  if(!motion) return;
+  arc = &motion->data.arc;
  
-  float theta_per_segment = angular_travel / segments;
-  float linear_per_segment = linear_travel / segments;
+  arc->theta_per_segment = angular_travel / segments;
+  arc->linear_per_segment = linear_travel / segments;
   
   /* Vector rotation by transformation matrix: r is the original vector, r_T is the rotated vector,
      and phi is the angle of rotation. Based on the solution approach by Jens Geisler.
@@ -139,56 +300,96 @@ void mc_arc(float *position, float *target, float *offset, uint8_t axis_0,
      numerical drift error. N_ARC_CORRECTION may be on the order a hundred(s) before error becomes an
      issue for CNC machines with the single precision Arduino calculations.
      
-     This approximation also allows mc_arc to immediately insert a line segment into the planner 
-     without the initial overhead of computing cos() or sin(). By the time the arc needs to be applied
-     a correction, the planner should have caught up to the lag caused by the initial mc_arc overhead. 
-     This is important when there are successive arc motions. 
+     This approximation also allows the arc generator to insert a line segment into the planner
+     without the overhead of computing cos() or sin() for most segments. By the time the arc needs to
+     be applied a correction, the planner should have caught up with the lag. This is important when
+     there are successive arc motions. 
   */
-  // Vector rotation matrix values
-  float cos_T = 1 - 0.5 * theta_per_segment * theta_per_segment; // Small angle approximation
-  float sin_T = theta_per_segment;
-  
-  float arc_target[3];
-  float sin_Ti;
-  float cos_Ti;
-  float r_axisi;
-  uint16_t i;
-  int8_t count = 0;
+  arc->cos_T = 1 - 0.5 * arc->theta_per_segment * arc->theta_per_segment; // Small angle approximation
+  arc->sin_T = arc->theta_per_segment;
 
+  arc->center_axis0 = center_axis0;
+  arc->center_axis1 = center_axis1;
+  arc->r_axis0 = r_axis0;
+  arc->r_axis1 = r_axis1;
+  arc->offset_axis0 = offset[axis_0];
+  arc->offset_axis1 = offset[axis_1];
   // Initialize the linear axis
-  arc_target[axis_linear] = position[axis_linear];
-
-  for(i = 1; i < segments; i++) { // Increment (segments-1)
-    if(count < N_ARC_CORRECTION) {
-      // Apply vector rotation matrix 
-      r_axisi = r_axis0*sin_T + r_axis1*cos_T;
-      r_axis0 = r_axis0*cos_T - r_axis1*sin_T;
-      r_axis1 = r_axisi;
-      count++;
-    } else {
-      // Arc correction to radius vector. Computed only every N_ARC_CORRECTION increments.
-      // Compute exact location by applying transformation matrix from initial radius vector(=-offset).
-      cos_Ti = cos(i*theta_per_segment);
-      sin_Ti = sin(i*theta_per_segment);
-      r_axis0 = -offset[axis_0] * cos_Ti + offset[axis_1] * sin_Ti;
-      r_axis1 = -offset[axis_0] * sin_Ti - offset[axis_1] * cos_Ti;
-      count = 0;
-    }
+  arc->linear_axis = position[axis_linear];
+  arc->axis_0 = axis_0;
+  arc->axis_1 = axis_1;
+  arc->axis_linear = axis_linear;
+  arc->segment = 1; // Increment (segments-1), the last one goes straight to target
+  arc->segments = segments;
+  arc->count = 0;
+  queue_push(target[X_AXIS], target[Y_AXIS], target[Z_AXIS], feed_rate, invert_feed_rate, MOTION_ARC);
+}
 
-    // Update arc_target location
-    arc_target[axis_0] = center_axis0 + r_axis0;
-    arc_target[axis_1] = center_axis1 + r_axis1;
-    arc_target[axis_linear] += linear_per_segment;
-    mc_line(arc_target[X_AXIS], arc_target[Y_AXIS], arc_target[Z_AXIS], feed_rate, invert_feed_rate);
+// Rapid move to point, for drilling cycles
+static void drill_rapid(float *point) {
+  mc_line(point[X_AXIS], point[Y_AXIS], point[Z_AXIS], settings.default_seek_rate, false);
+}
+
+// Execute one drilling cycle: position == current xyz, target == hole xyz with the bottom of the
+// hole along axis_drill, retract == R level, clear == level to leave the hole at. Drills in pecks
+// of peck, if not zero, backing off to retract after each one or, if chip_break, just enough to
+// break the chip. Dwells at the bottom for dwell seconds, if not zero.
+void mc_drill(float *position, float *target, uint8_t axis_drill, float retract, float clear,
+    float peck, bool chip_break, float dwell, float feed_rate) {
+  float point[3];
+  float depth = retract;
+  uint8_t i;
+
+  memcpy(point, position, sizeof(point));
+  // Get clear of the work before moving over the hole
+  if(point[axis_drill] < retract) {
+    point[axis_drill] = retract;
+    drill_rapid(point);
   }
-  // Ensure last segment arrives at target location.
-  mc_line(target[X_AXIS], target[Y_AXIS], target[Z_AXIS], feed_rate, invert_feed_rate);
+  for(i = 0; i <= 2; i++) if(i != axis_drill) point[i] = target[i];
+  drill_rapid(point);
+  point[axis_drill] = retract;
+  drill_rapid(point);
+
+  if(peck > 0) {
+    while(depth > target[axis_drill]) {
+      if(sys.abort) return;
+      depth -= peck;
+      if(depth < target[axis_drill]) depth = target[axis_drill];
+      point[axis_drill] = depth;
+      mc_line(point[X_AXIS], point[Y_AXIS], point[Z_AXIS], feed_rate, false);
+      if(depth > target[axis_drill]) {
+        if(!chip_break) {
+          point[axis_drill] = retract;
+          drill_rapid(point);
+        }
+        point[axis_drill] = depth + DRILL_PECK_CLEARANCE;
+        drill_rapid(point);
+      }
+    }
+  } else {
+    point[axis_drill] = target[axis_drill];
+    mc_line(point[X_AXIS], point[Y_AXIS], point[Z_AXIS], feed_rate, false);
+  }
+  if(dwell > 0) mc_dwell(dwell);
+
+  point[axis_drill] = clear;
+  drill_rapid(point);
+}
+
+// Pause the program once everything before is done, without holding up the parser.
+void mc_pause(bool optional) {
+  motion_t *motion = queue_next();
+
+  if(!motion) return;
+  motion->data.optional = optional;
+  queue_push(0, 0, 0, 0, false, MOTION_PAUSE);
 }
 
 // Execute dwell in seconds.
 void mc_dwell(float seconds) {
    uint16_t i = floor(1000 / DWELL_TIME_STEP * seconds);
-   plan_synchronize();
+   mc_synchronize();
    host_delay_ms(floor(1000 * seconds - i * DWELL_TIME_STEP)); // Delay millisecond remainder
    while(i--) {
      // NOTE: Check and execute runtime commands during dwell every <= DWELL_TIME_STEP milliseconds.
@@ -201,3 +402,14 @@ void mc_dwell(float seconds) {
 void mc_go_home() {
   limits_go_home();  
 }
+
+// Called by the real-time command filter on a reset request, from the serial Rx
+// interrupt where there is one. Stepping stops right here rather than when the
+// main program gets to execute_runtime(), which may be a while if it's busy.
+// NOTE: Machine position is not guaranteed after this, see the abort handling
+// in main().
+void mc_reset() {
+  if(bit_istrue(sys.execute, EXEC_RESET)) return; // Already on its way
+  st_abort();
+  bit_true(sys.execute, EXEC_RESET);
+}
@@ -27,20 +27,47 @@
 
 // Execute linear motion in absolute millimeter coordinates. Feed rate given in millimeters/second
 // unless invert_feed_rate is true. Then the feed_rate means that the motion should be completed in
-// (1 minute)/feed_rate time.
+// (1 minute)/feed_rate time. Queued for the planner if it's full, only blocks if the queue is full
+// as well.
 void mc_line(float x, float y, float z, float feed_rate, bool invert_feed_rate);
 
 // Execute an arc in offset mode format. position == current xyz, target == target xyz, 
 // offset == offset from current xyz, axis_XXX defines circle plane in tool space, axis_linear is
 // the direction of helical travel, radius == circle radius, isclockwise boolean. Used
-// for vector transformation direction.
+// for vector transformation direction. Queued like a line, its segments are generated as the planner
+// frees up room. Only blocks if the queue is full or the previous arc isn't all in the plan yet.
 void mc_arc(float *position, float *target, float *offset, uint8_t axis_0, uint8_t axis_1,
   uint8_t axis_linear, float feed_rate, bool invert_feed_rate, float radius, bool isclockwise);
   
+// Moves queued motions to the planner as it frees up room. Called by protocol while it reads on.
+void mc_pump();
+
+// Block until all queued and buffered motions are executed
+void mc_synchronize();
+
+// Clears the motion queue
+void mc_init();
+
+// Execute one drilling cycle, as in G73/G81/G82/G83: position == current xyz, target == hole xyz
+// with the bottom of the hole along axis_drill, retract == R level, clear == level to leave the hole
+// at, all in absolute millimeters. peck == depth of each peck or zero to drill in one go,
+// chip_break == back off just enough to break the chip between pecks instead of leaving the hole.
+void mc_drill(float *position, float *target, uint8_t axis_drill, float retract, float clear,
+  float peck, bool chip_break, float dwell, float feed_rate);
+
+// Pause the program (M0, M1) once all motions before are done: motions after only start on cycle
+// start. Queued like a motion, returns right away. An optional pause (M1) only pauses if the
+// optional stop switch is on by the time all motions before it have gone into the planner.
+void mc_pause(bool optional);
+
 // Dwell for a specific number of seconds
 void mc_dwell(float seconds);
 
 // Send the tool home (not implemented)
 void mc_go_home();
 
+// Performs a system reset: stops the steppers at once and flags the main program to abort.
+// Safe to call from interrupts.
+void mc_reset();
+
 #endif
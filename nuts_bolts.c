@@ -24,6 +24,8 @@
 
 #include "config.h"
 
+#include "nuts_bolts.h"
+
 
 // Resolution of IEEE754 single (ANSI C float) is exactly 7.22 decimal digits.
 // Current day CNCs have micron resolution and under 10m carriages thus giving
@@ -50,40 +52,42 @@
 // be recognized.
 // NOTE: Thanks to Radu-Eosif Mihailescu for identifying the issues with using
 //       strtod().
-bool read_float(char *line, uint8_t *char_counter, float *float_ptr) {
-  char *ptr = line + *char_counter;
-  unsigned char c;
-  bool isNegative = false, seenDecimalPoint = false;
-  uint32_t intval = 0;
-  int8_t exp = 0;
-  uint8_t nDigits = 0;
-  float result;
-
-  // Test for leading sign character. All spaces have already been
-  // stripped from the line.
-  if(*ptr == '-') isNegative = true;
-  if(*ptr == '+' || *ptr == '-') c = *(++ptr);
-  else c = *ptr;
+void number_start(number_reader_t *reader) {
+  reader->intval = 0;
+  reader->exp = 0;
+  reader->digits = 0;
+  reader->negative = false;
+  reader->decimal = false;
+  reader->started = false;
+}
 
+bool number_feed(number_reader_t *reader, char c) {
+  // Leading sign character
+  if(!reader->started && (c == '-' || c == '+')) reader->negative = (c == '-');
   // Extract number into fast integer. Track decimal point position in terms of
   // exponent value.
-  while((c <= '9' && c >= '0') || (c == '.' && !seenDecimalPoint)) {
-    if(c == '.') seenDecimalPoint = true;
-    else {
-      nDigits++;
-      if(nDigits <= MAX_INT_DIGITS) {
-        if(seenDecimalPoint) exp--;
-        intval = (intval << 3) + (intval << 1) + (c - '0'); // intval * 10 + c
-      } else if(!(seenDecimalPoint)) exp++; // Drop overflow digits
-    }
-    c = *(++ptr);
-  }
+  else if(c == '.' && !reader->decimal) reader->decimal = true;
+  else if(c <= '9' && c >= '0') {
+    reader->digits++;
+    if(reader->digits <= MAX_INT_DIGITS) {
+      if(reader->decimal) reader->exp--;
+      reader->intval = (reader->intval << 3) + (reader->intval << 1) + (c - '0'); // intval * 10 + c
+    } else if(!reader->decimal) reader->exp++; // Drop overflow digits
+  } else return false;
+  reader->started = true;
 
-  // Return now if no digits have been read.
-  if(!nDigits) return false;
+  return true;
+}
+
+bool number_finish(number_reader_t *reader, float *float_ptr) {
+  int8_t exp = reader->exp;
+  float result;
+
+  // Fail if no digits have been read.
+  if(!reader->digits) return false;
 
   // Convert integer into floating point.
-  result = intval;
+  result = reader->intval;
 
   // Apply decimal point. Should perform no more than two floating point
   // multiplications for the expected range of E0 to E-4.
@@ -97,9 +101,38 @@ bool read_float(char *line, uint8_t *char_counter, float *float_ptr) {
   }
 
   // Apply sign.
-  if(isNegative) *float_ptr = -result;
+  if(reader->negative) *float_ptr = -result;
   else *float_ptr = result;
 
+  return true;
+}
+
+bool number_finish_code(number_reader_t *reader, int32_t *code_ptr) {
+  int8_t exp = reader->exp + 1; // Scale by 10
+  uint32_t result = reader->intval;
+
+  // Fail if no digits have been read.
+  if(!reader->digits) return false;
+
+  // Apply decimal point, dropping whatever is past the first decimal. Saturate
+  // rather than overflow on absurdly long integer parts.
+  for(; exp < 0; exp++) result /= 10;
+  for(; exp > 0; exp--) result = (result > INT32_MAX / 10) ? INT32_MAX : result * 10;
+
+  // Apply sign.
+  if(reader->negative) *code_ptr = -(int32_t)result;
+  else *code_ptr = result;
+
+  return true;
+}
+
+bool read_float(char *line, uint8_t *char_counter, float *float_ptr) {
+  number_reader_t reader;
+  char *ptr = line + *char_counter;
+
+  number_start(&reader);
+  while(*ptr && number_feed(&reader, *ptr)) ptr++;
+  if(!number_finish(&reader, float_ptr)) return false;
   *char_counter = ptr - line; // Set char_counter to next statement
 
   return true;
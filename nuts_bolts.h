@@ -50,7 +50,7 @@
 // limit). The default flags are always false, so the runtime protocol only
 // needs to check for a non-zero value to know when there is a runtime command
 // to execute.
-// #define                  bit(0) // bitmask 00000001
+#define EXEC_STATUS_REPORT  bit(0) // bitmask 00000001
 #define EXEC_CYCLE_START    bit(1) // bitmask 00000010
 #define EXEC_CYCLE_STOP     bit(2) // bitmask 00000100
 #define EXEC_FEED_HOLD      bit(3) // bitmask 00001000
@@ -64,7 +64,8 @@ typedef struct {
   uint8_t abort:1;               // System abort flag. Forces exit back to main loop for reset.
   uint8_t feed_hold:1;           // Feed hold flag. Held true during feed hold. Released when ready to resume.
   uint8_t auto_start:1;          // Planner auto-start flag. Toggled off during feed hold. Defaulted by settings.
-  uint8_t reserved_flags1:5;     // Hold the other 5 bits, make sure gcc doesn't get ideas about them
+  uint8_t opt_stop:1;            // Optional stop switch, M1 only pauses when on. Toggled by '$O', survives resets.
+  uint8_t reserved_flags1:4;     // Hold the other 4 bits, make sure gcc doesn't get ideas about them
   int32_t position[3];           // Real-time machine (aka home) position vector in steps. 
                                  // NOTE: This may need to be a volatile variable, if problems arise. 
   uint8_t coord_select;          // Active work coordinate system number. Default: 0=G54.
@@ -76,6 +77,30 @@ typedef struct {
 } system_t;
 extern system_t sys;
 
+// Incremental floating point value reader, fed one character at a time as the
+// characters arrive. Follows the rules of read_float() below.
+typedef struct {
+  uint32_t intval;    // Digits read so far, as an integer
+  int8_t exp;         // Decimal exponent to apply to intval
+  uint8_t digits;     // Number of digits read
+  uint8_t negative:1; // Leading '-' seen
+  uint8_t decimal:1;  // Decimal point seen
+  uint8_t started:1;  // Anything seen, a sign is no longer allowed
+  uint8_t reserved:5; // Make sure GCC doesn't get any ideas with remaining bits
+} number_reader_t;
+
+// Prepares reader for a new value
+void number_start(number_reader_t *reader);
+// Feeds character c to reader. Returns false, leaving reader untouched, if c
+// cannot be part of the value (i.e. it is the first character after it).
+bool number_feed(number_reader_t *reader, char c);
+// Converts the value read into float_ptr. Returns false if no digits were read.
+bool number_finish(number_reader_t *reader, float *float_ptr);
+// Converts the value read into code_ptr as an integer scaled by 10, i.e. keeping
+// one decimal, without any floating point work. Returns false if no digits were
+// read.
+bool number_finish_code(number_reader_t *reader, int32_t *code_ptr);
+
 // Read a floating point value from a string. Line points to the input buffer,
 // char_counter is the index of the current character on the line (i.e. where
 // conversion should start) while float_ptr is a pointer to the result.
@@ -50,6 +50,13 @@ typedef struct {
   float previous_nominal_speed;   // Nominal speed of previous path line segment
 } planner_t;
 static planner_t pl;
+#ifdef PLANNER_TELEMETRY
+  static plan_telemetry_t telemetry;    // Statistics for the console, see PLANNER_TELEMETRY
+  static uint16_t replan_kernel_visits; // Work done by the current planner_recalculate()
+  static uint16_t replan_trapezoids;
+  static volatile bool synchronizing;   // Buffer is being drained on purpose
+  static volatile bool pausing;         // ... by a program pause waiting for it to run dry
+#endif
 
 
 // Returns the index of the next block in the ring buffer
@@ -107,6 +114,9 @@ static float max_allowable_speed(float acceleration, float target_velocity,
 static void planner_reverse_pass_kernel(block_t *previous, block_t *current, block_t *next) 
 {
   if (!current) { return; }  // Cannot operate on nothing.
+  #ifdef PLANNER_TELEMETRY
+    replan_kernel_visits++;
+  #endif
   
   if (next) { 
     // If entry speed is already at the maximum entry speed, no need to recheck. Block is cruising.
@@ -150,6 +160,9 @@ static void planner_reverse_pass()
 static void planner_forward_pass_kernel(block_t *previous, block_t *current, block_t *next) 
 {
   if(!previous) { return; }  // Begin planning after buffer_tail
+  #ifdef PLANNER_TELEMETRY
+    replan_kernel_visits++;
+  #endif
   
   // If the previous block is an acceleration block, but it is not long enough to complete the
   // full speed change within the block, we need to adjust the entry speed accordingly. Entry
@@ -202,6 +215,9 @@ static void planner_forward_pass()
 // NOTE: Final rates must be computed in terms of their respective blocks.
 static void calculate_trapezoid_for_block(block_t *block, float entry_factor, float exit_factor) 
 {  
+  #ifdef PLANNER_TELEMETRY
+    replan_trapezoids++;
+  #endif
   block->initial_rate = ceil(block->nominal_rate*entry_factor); // (step/min)
   block->final_rate = ceil(block->nominal_rate*exit_factor); // (step/min)
   int32_t acceleration_per_minute = block->rate_delta*ACCELERATION_TICKS_PER_SECOND*60.0; // (step/min^2)
@@ -305,6 +321,9 @@ void plan_init()
 {
   plan_reset_buffer();
   memset(&pl, 0, sizeof(pl)); // Clear planner struct
+  #ifdef PLANNER_TELEMETRY
+    pausing = false;
+  #endif
 }
 
 inline void plan_discard_current_block() 
@@ -333,14 +352,57 @@ uint8_t plan_check_full_buffer()
   return(false);
 }
 
+// Returns the number of blocks queued in the buffer, including the one being executed
+uint8_t plan_get_block_count()
+{
+  uint8_t head = block_buffer_head, tail = block_buffer_tail;
+
+  if (head >= tail) { return(head - tail); }
+  return(head + BLOCK_BUFFER_SIZE - tail);
+}
+
 // Block until all buffered steps are executed.
 void plan_synchronize()
 {
+  #ifdef PLANNER_TELEMETRY
+    synchronizing = true;
+  #endif
   while (plan_get_current_block() || sys.cycle_start) { 
     execute_runtime();   // Check and execute run-time commands
-    if (sys.abort) { return; } // Check for system abort
+    if (sys.abort) { break; } // Check for system abort
   }    
+  #ifdef PLANNER_TELEMETRY
+    synchronizing = false;
+  #endif
+}
+
+#ifdef PLANNER_TELEMETRY
+void plan_telemetry_fetch(plan_telemetry_t *result)
+{
+  host_cli();
+  *result = telemetry;
+  memset(&telemetry, 0, sizeof(telemetry));
+  host_sei();
+}
+
+void plan_telemetry_tick()
+{
+  uint8_t count = plan_get_block_count();
+
+  if (count <= 1) { telemetry.ticks_starving++; }
+  telemetry.histogram[(count * (PLAN_TELEMETRY_BINS - 1)) / (BLOCK_BUFFER_SIZE - 1)]++;
+}
+
+void plan_telemetry_underrun()
+{
+  if (!synchronizing && !pausing && telemetry.underruns < UINT16_MAX) { telemetry.underruns++; }
+}
+
+void plan_telemetry_pausing(bool waiting)
+{
+  pausing = waiting;
 }
+#endif
 
 // Add a new linear movement to the buffer. x, y and z is the signed, absolute target position in 
 // millimeters. Feed rate specifies the speed of the motion. If feed rate is inverted, the feed
@@ -477,7 +539,18 @@ void plan_buffer_line(float x, float y, float z, float feed_rate, uint8_t invert
   // Update planner position
   memcpy(pl.position, target, sizeof(target)); // pl.position[] = target[]
 
+  #ifdef PLANNER_TELEMETRY
+    replan_kernel_visits = 0;
+    replan_trapezoids = 0;
+  #endif
   planner_recalculate(); 
+  #ifdef PLANNER_TELEMETRY
+    telemetry.blocks++;
+    telemetry.kernel_visits += replan_kernel_visits;
+    telemetry.trapezoids += replan_trapezoids;
+    if (replan_kernel_visits > telemetry.max_kernel_visits) { telemetry.max_kernel_visits = replan_kernel_visits; }
+    if (replan_trapezoids > telemetry.max_trapezoids) { telemetry.max_trapezoids = replan_trapezoids; }
+  #endif
 }
 
 // Reset the planner position vector (in steps). Called by the system abort routine.
@@ -83,5 +83,32 @@ uint8_t plan_check_full_buffer();
 // Block until all buffered steps are executed
 void plan_synchronize();
 
+// Returns the number of blocks queued in the buffer, including the one being executed
+uint8_t plan_get_block_count();
+
+// Planner and buffer statistics, see PLANNER_TELEMETRY in config.h
+#define PLAN_TELEMETRY_TICKS_PER_SECOND 100 // Buffer occupancy sampling rate while in motion
+#define PLAN_TELEMETRY_BINS 5 // Occupancy histogram: four quarters of the buffer, last bin full
+typedef struct {
+  uint16_t underruns;          // Times the buffer ran dry in motion other than when synchronizing
+                               // or pausing
+  uint32_t ticks_starving;     // Ticks spent in motion with at most one block queued
+  uint32_t histogram[PLAN_TELEMETRY_BINS]; // Ticks spent in motion, by buffer occupancy
+  uint32_t blocks;             // Blocks planned
+  uint32_t kernel_visits;      // Reverse and forward pass kernel runs, summed over all blocks
+  uint16_t max_kernel_visits;  // ... worst for a single block
+  uint32_t trapezoids;         // Trapezoid recalculations, summed over all blocks
+  uint16_t max_trapezoids;     // ... worst for a single block
+} plan_telemetry_t;
+
+// Copies and clears the planner statistics
+void plan_telemetry_fetch(plan_telemetry_t *result);
+// Samples buffer occupancy, called by the stepper subsystem in motion
+void plan_telemetry_tick();
+// Accounts for the stepper subsystem finding the buffer empty in motion
+void plan_telemetry_underrun();
+// Tells whether a program pause is waiting for the buffer to run dry, which is then no underrun
+void plan_telemetry_pausing(bool waiting);
+
 
 #endif
@@ -19,25 +19,186 @@
   along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <math.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "config.h"
 
 #include "protocol.h"
 
+#include "binary_protocol.h"
 #include "gcode.h"
+#include "motion_control.h"
 #include "nuts_bolts.h"
+#include "planner.h"
 #include "runtime.h"
 #include "settings.h"
+#include "stepper.h"
 
 
-static char line[LINE_BUFFER_SIZE]; // Line to be executed. Zero-terminated.
+#define LINE_MODE_EMPTY 0 // Nothing but whitespace and comments so far
+#define LINE_MODE_SETTING 1 // '$' line, stored as is in line
+#define LINE_MODE_BLOCK 2 // G-code block, split into words in block as it arrives
+
+static union {
+  char line[LINE_BUFFER_SIZE]; // '$' line to be executed. Zero-terminated.
+  gc_block_t block; // G-code block to be executed
+} input;
+static uint8_t line_mode; // What kind of line is being received
+static uint8_t line_status; // First error met while receiving a '$' line
 static uint8_t char_counter; // Last character counter in line variable.
 static uint8_t iscomment; // Comment/block delete flag for processor to ignore comment characters.
+static char report[REPORT_BUFFER_SIZE]; // Status report being sent. Zero-terminated, empty if none.
+static uint8_t report_index; // Next character of report to be sent.
+
+// Carries out real-time command c, returns false if it is none
+static bool realtime_command(char c) {
+  switch(c) {
+    case CMD_STATUS_REPORT: bit_true(sys.execute, EXEC_STATUS_REPORT); return true;
+    case CMD_FEED_HOLD: bit_true(sys.execute, EXEC_FEED_HOLD); return true;
+    case CMD_CYCLE_START: bit_true(sys.execute, EXEC_CYCLE_START); return true;
+    case CMD_RESET: mc_reset(); return true;
+    default: return false;
+  }
+}
+
+// Picks real-time commands off the serial receive stream, at interrupt level where available
+static bool realtime_filter(char c) {
+  #ifdef BINARY_PROTOCOL
+    // Frames may contain anything, real-time commands then come in frames of their own. These
+    // are left in the stream, so that bp_process() keeps track of where frames start.
+    if(bp_filter(c, &c)) {
+      realtime_command(c);
+      return false;
+    }
+  #endif
+  return realtime_command(c);
+}
+
+// Appends constant string s to the report at index, returns the new index
+static uint8_t report_message(uint8_t index, const char *s) {
+  char c;
+
+  while((c = host_fetch_S(s++))) report[index++] = c;
+
+  return index;
+}
+
+// Appends unsigned integer n to the report at index, returns the new index
+static uint8_t report_integer(uint8_t index, uint32_t n) {
+  char digits[10];
+  uint8_t i = 0;
+
+  do {
+    digits[i++] = '0' + n % 10;
+    n /= 10;
+  } while(n);
+  while(i) report[index++] = digits[--i];
+
+  return index;
+}
+
+// Appends value with DECIMAL_PLACES decimals to the report at index, returns the new index
+static uint8_t report_decimal(uint8_t index, float value) {
+  int32_t n = lround(value * DECIMAL_MULTIPLIER);
+  uint8_t i;
+  uint32_t scale = 1;
+
+  if(n < 0) {
+    report[index++] = '-';
+    n = -n;
+  }
+  index = report_integer(index, n / DECIMAL_MULTIPLIER);
+  report[index++] = '.';
+  n %= DECIMAL_MULTIPLIER;
+  for(i = 1; i < DECIMAL_PLACES; i++) scale *= 10;
+  for(; scale; scale /= 10) report[index++] = '0' + (n / scale) % 10;
+
+  return index;
+}
+
+// Appends an axis vector to the report at index, returns the new index
+static uint8_t report_vector(uint8_t index, float *vector) {
+  uint8_t i;
+
+  for(i = 0; i < 3; i++) {
+    if(i) report[index++] = ',';
+    #if REPORT_INCH_MODE
+      index = report_decimal(index, vector[i] / MM_PER_INCH);
+    #else
+      index = report_decimal(index, vector[i]);
+    #endif
+  }
+
+  return index;
+}
+
+// Formats the status report, a single line looking like
+// <Run,MPos:10.00,5.00,0.00,WPos:0.00,5.00,0.00,Buf:12,RX:98>
+static void report_build(void) {
+  int32_t position[3];
+  float machine[3], work[3];
+  uint8_t i, index = 0;
+
+  host_cli(); // sys.position is updated by the stepper interrupt
+  memcpy(position, sys.position, sizeof(position));
+  host_sei();
+  for(i = 0; i < 3; i++) {
+    machine[i] = position[i] / settings.steps_per_mm[i];
+    work[i] = machine[i] - sys.coord_system[sys.coord_select][i] - sys.coord_offset[i];
+  }
+
+  report[index++] = '<';
+  if(sys.feed_hold) index = report_message(index, _S("Hold"));
+  else if(sys.cycle_start) index = report_message(index, _S("Run"));
+  else index = report_message(index, _S("Idle"));
+  index = report_message(index, _S(",MPos:"));
+  index = report_vector(index, machine);
+  index = report_message(index, _S(",WPos:"));
+  index = report_vector(index, work);
+  index = report_message(index, _S(",Buf:"));
+  index = report_integer(index, plan_get_block_count());
+  index = report_message(index, _S(",RX:"));
+  index = report_integer(index, host_serialconsole_rx_free());
+  index = report_message(index, _S(">\r\n"));
+  report[index] = 0;
+  report_index = 0;
+}
+
+// Sends as much of the pending status report as the Tx buffer takes, or all of
+// it if block is set. Returns true when nothing is left to send.
+static bool report_send(bool block) {
+  while(report[report_index]) {
+    if(!host_serialconsole_write(report[report_index], block)) return false;
+    report_index++;
+  }
+  report[0] = 0;
+
+  return true;
+}
+
+void protocol_status_report() {
+  if(!report[0]) report_build();
+  if(report_send(false)) bit_false(sys.execute, EXEC_STATUS_REPORT);
+}
+
+// Sends whatever is left of a pending status report, so that it is never cut in half
+static void report_finish(void) {
+  if(report[0] && report_send(true)) bit_false(sys.execute, EXEC_STATUS_REPORT);
+}
 
 static void status_message(int status_code) {
-  if(!status_code) host_serialconsole_printmessage(_S("ok\r\n"), true);
-  else {
+  report_finish();
+  if(!status_code) {
+    #ifdef REPORT_RX_FREE
+      host_serialconsole_printmessage(_S("ok:"), true);
+      host_serialconsole_printinteger(host_serialconsole_rx_free(), true);
+      host_serialconsole_printmessage(_S("\r\n"), true);
+    #else
+      host_serialconsole_printmessage(_S("ok\r\n"), true);
+    #endif
+  } else {
     host_serialconsole_printmessage(_S("error: "), true);
     switch(status_code) {          
       case STATUS_BAD_NUMBER_FORMAT: host_serialconsole_printmessage(_S("Bad number format\r\n"), true); break;
@@ -46,6 +207,8 @@ static void status_message(int status_code) {
       case STATUS_FLOATING_POINT_ERROR: host_serialconsole_printmessage(_S("Floating point error\r\n"), true); break;
       case STATUS_MODAL_GROUP_VIOLATION: host_serialconsole_printmessage(_S("Modal group violation\r\n"), true); break;
       case STATUS_INVALID_COMMAND: host_serialconsole_printmessage(_S("Invalid command\r\n"), true); break;
+      case STATUS_BAD_FRAME: host_serialconsole_printmessage(_S("Bad frame\r\n"), true); break;
+      case STATUS_OVERFLOW: host_serialconsole_printmessage(_S("Line overflow\r\n"), true); break;
       default:
        host_serialconsole_printinteger(status_code, true);
        host_serialconsole_printmessage(_S("\r\n"), true);
@@ -54,19 +217,166 @@ static void status_message(int status_code) {
   }
 }
 
+static void line_reset(void) {
+  line_mode = LINE_MODE_EMPTY;
+  line_status = STATUS_OK;
+  char_counter = 0;
+  iscomment = false;
+}
+
+// Takes in the next character of the line. Comments, whitespace and lower case are already taken
+// care of. G-code is split into words (a letter and its value) right as it arrives.
+static void line_feed(char c) {
+  if(line_mode == LINE_MODE_EMPTY) {
+    if(c == '$') line_mode = LINE_MODE_SETTING;
+    else {
+      line_mode = LINE_MODE_BLOCK;
+      gc_block_start(&input.block);
+    }
+  }
+  if(line_mode == LINE_MODE_SETTING) {
+    if(char_counter < LINE_BUFFER_SIZE - 1) input.line[char_counter++] = c;
+    else line_status = STATUS_OVERFLOW;
+  } else gc_block_feed(&input.block, c);
+}
+
+// Executes the line received, returns its status
+static uint8_t line_execute(void) {
+  switch(line_mode) {
+    case LINE_MODE_SETTING:
+      input.line[char_counter] = 0; // Terminate string
+      if(!line_status) line_status = protocol_execute_line(input.line);
+      break;
+    case LINE_MODE_BLOCK:
+      line_status = gc_block_finish(&input.block);
+      if(!line_status) line_status = gc_execute_block(&input.block);
+      break;
+  }
+
+  return line_status;
+}
+
 void protocol_init() {
   // Print grbl initialization message
-  host_serialconsole_printmessage(_S("\r\nGrbl " GRBL_VERSION), true);
+  host_serialconsole_printmessage(_S("\r\nGrbl " GRBL_VERSION " [RX:"), true);
+  // Serial link parameters, for streaming scripts to size their flow control after
+  host_serialconsole_printinteger(CONSOLE_RXBUF_SIZE, true);
+  host_serialconsole_printmessage(_S(",TX:"), true);
+  host_serialconsole_printinteger(CONSOLE_TXBUF_SIZE, true);
+  host_serialconsole_printmessage(_S(",BAUD:"), true);
+  host_serialconsole_printinteger(CONSOLE_BAUD_RATE, true);
+  host_serialconsole_write(']', true);
   host_serialconsole_printmessage(_S("\r\n'$' to dump current settings\r\n"), true);
 
-  char_counter = 0; // Reset line input
-  iscomment = false;
+  line_reset(); // Reset line input
+  report[0] = 0; // Scrap any report left half way
+  #ifdef BINARY_PROTOCOL
+    bp_init();
+  #endif
+  host_serialconsole_set_filter(realtime_filter);
 }
 
 
+#ifdef STEPPER_ISR_TIMING
+// Prints (and clears) the step interrupt timing statistics
+static void timing_report(void) {
+  stepper_timing_t timing;
+  uint8_t i;
+
+  st_timing_fetch(&timing);
+  if(!timing.samples) {
+    host_serialconsole_printmessage(_S("Step ISR: no samples\r\n"), true);
+    return;
+  }
+  host_serialconsole_printmessage(_S("Step ISR cycles min/avg/max: "), true);
+  host_serialconsole_printinteger(timing.min_cycles, true);
+  host_serialconsole_write('/', true);
+  host_serialconsole_printinteger(timing.total_cycles / timing.total_samples, true);
+  host_serialconsole_write('/', true);
+  host_serialconsole_printinteger(timing.max_cycles, true);
+  host_serialconsole_printmessage(_S(" (max at a period of "), true);
+  host_serialconsole_printinteger(timing.max_period, true);
+  host_serialconsole_printmessage(_S(")\r\nShortest period: "), true);
+  host_serialconsole_printinteger(timing.min_period, true);
+  host_serialconsole_printmessage(_S(", headroom: "), true);
+  if(timing.max_cycles < timing.min_period)
+    host_serialconsole_printinteger(timing.min_period - timing.max_cycles, true);
+  else host_serialconsole_printmessage(_S("none"), true);
+  host_serialconsole_printmessage(_S("\r\nSamples: "), true);
+  host_serialconsole_printinteger(timing.samples, true);
+  host_serialconsole_printmessage(_S(", busy rejections: "), true);
+  host_serialconsole_printinteger(timing.busy_rejections, true);
+  host_serialconsole_printmessage(_S(", late: "), true);
+  host_serialconsole_printinteger(timing.late, true);
+  host_serialconsole_printmessage(_S("\r\nHistogram (<256,<512,..):"), true);
+  for(i = 0; i < STEPPER_TIMING_BINS; i++) {
+    host_serialconsole_write(' ', true);
+    host_serialconsole_printinteger(timing.histogram[i], true);
+  }
+  host_serialconsole_printmessage(_S("\r\n"), true);
+}
+#endif
+
+#ifdef PLANNER_TELEMETRY
+// Prints (and clears) the planner statistics
+static void telemetry_report(void) {
+  plan_telemetry_t telemetry;
+  uint32_t ticks = 0;
+  uint8_t i;
+
+  plan_telemetry_fetch(&telemetry);
+  for(i = 0; i < PLAN_TELEMETRY_BINS; i++) ticks += telemetry.histogram[i];
+  host_serialconsole_printmessage(_S("Planner underruns: "), true);
+  host_serialconsole_printinteger(telemetry.underruns, true);
+  host_serialconsole_printmessage(_S("\r\nIn motion: "), true);
+  host_serialconsole_printinteger(ticks * (1000 / PLAN_TELEMETRY_TICKS_PER_SECOND), true);
+  host_serialconsole_printmessage(_S("ms, full: "), true);
+  host_serialconsole_printinteger(telemetry.histogram[PLAN_TELEMETRY_BINS - 1] *
+      (1000 / PLAN_TELEMETRY_TICKS_PER_SECOND), true);
+  host_serialconsole_printmessage(_S("ms, starving: "), true);
+  host_serialconsole_printinteger(telemetry.ticks_starving * (1000 / PLAN_TELEMETRY_TICKS_PER_SECOND), true);
+  host_serialconsole_printmessage(_S("ms\r\nOccupancy (quarters,full):"), true);
+  for(i = 0; i < PLAN_TELEMETRY_BINS; i++) {
+    host_serialconsole_write(' ', true);
+    host_serialconsole_printinteger(telemetry.histogram[i], true);
+  }
+  host_serialconsole_printmessage(_S("\r\nBlocks: "), true);
+  host_serialconsole_printinteger(telemetry.blocks, true);
+  if(telemetry.blocks) {
+    host_serialconsole_printmessage(_S(", kernel runs/block avg/max: "), true);
+    host_serialconsole_printfloat((float)telemetry.kernel_visits / telemetry.blocks, 1, true);
+    host_serialconsole_write('/', true);
+    host_serialconsole_printinteger(telemetry.max_kernel_visits, true);
+    host_serialconsole_printmessage(_S(", trapezoids/block avg/max: "), true);
+    host_serialconsole_printfloat((float)telemetry.trapezoids / telemetry.blocks, 1, true);
+    host_serialconsole_write('/', true);
+    host_serialconsole_printinteger(telemetry.max_trapezoids, true);
+  }
+  host_serialconsole_printmessage(_S("\r\n"), true);
+}
+#endif
+
 // Executes one line of input according to protocol
 uint8_t protocol_execute_line(char *line) {
   if(line[0] == '$') {
+    #ifdef STEPPER_ISR_TIMING
+      if(line[1] == 'I' && line[2] == 0) {
+        timing_report();
+        return(STATUS_OK);
+      }
+    #endif
+    if(line[1] == 'O' && line[2] == 0) {
+      sys.opt_stop = !sys.opt_stop;
+      if(sys.opt_stop) host_serialconsole_printmessage(_S("Optional stop on\r\n"), true);
+      else host_serialconsole_printmessage(_S("Optional stop off\r\n"), true);
+      return(STATUS_OK);
+    }
+    #ifdef PLANNER_TELEMETRY
+      if(line[1] == 'P' && line[2] == 0) {
+        telemetry_report();
+        return(STATUS_OK);
+      }
+    #endif
     // TODO: Re-write this '$' as a way to change runtime settings without having to reset, i.e.
     // auto-starting, status query output formatting and type, jog mode (axes, direction, and
     // nominal feedrate), toggle block delete, etc. This differs from the EEPROM settings, as they
@@ -93,14 +403,33 @@ uint8_t protocol_execute_line(char *line) {
   // block buffer without having the planner plan them. It would need to manage de/ac-celerations 
   // on its own carefully. This approach could be effective and possibly size/memory efficient.
 
-  } else return(gc_execute_line(line));    // Everything else is gcode
+  } else return(STATUS_INVALID_COMMAND); // G-code is split into words on arrival instead
 }
 
 
-// Process one line of incoming serial data. Remove unneeded characters and capitalize.
+// Process incoming serial data as it arrives. Remove unneeded characters and capitalize.
 void protocol_process() {
-  uint8_t c;
+  int c;
+
+  execute_runtime(); // Runtime command check point, also while idle
+  if(sys.abort) return;
+  mc_pump(); // Feed the planner whatever it has room for by now
   while((c = host_serialconsole_read()) != CONSOLE_NO_DATA) {
+    mc_pump(); // ... and keep feeding it while reading on
+    #ifdef BINARY_PROTOCOL
+      // Binary frames start with a byte that never occurs in g-code and may come in between lines
+      // or even in the middle of one, which then carries on after the frame.
+      if(bp_busy() || c == BP_SYNC) {
+        if(bp_process(c)) { // Frame is complete. Then execute!
+          execute_runtime();
+          if(sys.abort) return;
+          c = bp_execute();
+          report_finish();
+          bp_acknowledge(c);
+        }
+        continue;
+      }
+    #endif
     if ((c == '\n') || (c == '\r')) { // End of line reached
       // Runtime command check point before executing line. Prevent any further line executions.
       // NOTE: If there is no line, this function should quickly return to the main program when
@@ -108,15 +437,10 @@ void protocol_process() {
       execute_runtime();
       if(sys.abort) return; // Bail to main program upon system abort
 
-      if(char_counter > 0) {// Line is complete. Then execute!
-        line[char_counter] = 0; // Terminate string
-        status_message(protocol_execute_line(line));
-      } else { 
-        // Empty or comment line. Skip block.
-        status_message(STATUS_OK); // Send status message for syncing purposes.
-      }
-      char_counter = 0; // Reset line buffer index
-      iscomment = false; // Reset comment flag
+      // Line is complete. Then execute! Empty or comment lines are skipped but still get a status
+      // message for syncing purposes.
+      status_message(line_execute());
+      line_reset(); // Reset line input and comment flag
     } else {
       if(iscomment) {
         // Throw away all comment characters
@@ -135,12 +459,10 @@ void protocol_process() {
         } else if(c == '(') {
           // Enable comments flag and ignore all characters until ')' or EOL.
           iscomment = true;
-        } else if(char_counter >= LINE_BUFFER_SIZE - 1) {
-          // Throw away any characters beyond the end of the line buffer
         } else if(c >= 'a' && c <= 'z') { // Upcase lowercase
-          line[char_counter++] = c - 'a'+'A';
+          line_feed(c - 'a'+'A');
         } else {
-          line[char_counter++] = c;
+          line_feed(c);
         }
       }
     }
@@ -28,8 +28,11 @@
 #define STATUS_FLOATING_POINT_ERROR 4
 #define STATUS_MODAL_GROUP_VIOLATION 5
 #define STATUS_INVALID_COMMAND 6
+#define STATUS_BAD_FRAME 7
+#define STATUS_OVERFLOW 8
 
-#define LINE_BUFFER_SIZE 50
+#define LINE_BUFFER_SIZE 50 // '$' lines only, g-code is split into words on arrival
+#define REPORT_BUFFER_SIZE 128
 
 
 // Initialize the serial protocol
@@ -39,8 +42,13 @@ void protocol_init();
 // come in. Blocks until the serial buffer is emptied. 
 void protocol_process();
 
-// Executes one line of input according to protocol
+// Executes one '$' line of input according to protocol
 uint8_t protocol_execute_line(char *line);
 
+// Sends the real-time status report requested with CMD_STATUS_REPORT. Never
+// blocks: whatever does not fit in the Tx buffer is sent on subsequent calls,
+// EXEC_STATUS_REPORT is only cleared once the whole report is out.
+void protocol_status_report();
+
 
 #endif
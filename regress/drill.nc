@@ -0,0 +1,31 @@
+(Drilling grids: G81 spot drilling, G83 pecking, G82 incremental with repeats)
+G21 G90 G17
+M3
+G0 X0 Y0 Z5
+G98 G81 X0 Y0 Z-3 R1 F150
+X10 Y0
+X20 Y0
+X30 Y0
+X0 Y10
+X10 Y10
+X20 Y10
+X30 Y10
+X0 Y20
+X10 Y20
+X20 Y20
+X30 Y20
+G80
+G0 Z5
+G99 G83 X5 Y5 Z-8 R1 Q2 F150
+X15 Y5
+X25 Y5
+X5 Y15
+X15 Y15
+X25 Y15
+G80
+G91 G82 X10 Y0 Z-3 R1 P0.5 L3 F150
+G90 G80
+M5
+G0 Z5
+G0 X0 Y0
+M2
@@ -0,0 +1,48 @@
+(Arc-heavy engraving: scallops, full circles, R-format arcs)
+G21 G90 G17
+M3
+G0 Z5
+G0 X0 Y0
+G1 Z-0.2 F100
+G3 X4 Y0 I2 J0 F300
+G2 X8 Y0 I2 J0
+G3 X12 Y0 I2 J0 F300
+G2 X16 Y0 I2 J0
+G3 X20 Y0 I2 J0 F300
+G2 X24 Y0 I2 J0
+G3 X28 Y0 I2 J0 F300
+G2 X32 Y0 I2 J0
+G3 X36 Y0 I2 J0 F300
+G2 X40 Y0 I2 J0
+G3 X44 Y0 I2 J0 F300
+G2 X48 Y0 I2 J0
+G0 Z1
+G0 X3 Y15
+G1 Z-0.2
+G2 X3 Y15 I5 J0
+G2 X3 Y15 I3 J0
+G0 Z1
+G0 X17 Y15
+G1 Z-0.2
+G2 X17 Y15 I5 J0
+G2 X17 Y15 I3 J0
+G0 Z1
+G0 X31 Y15
+G1 Z-0.2
+G2 X31 Y15 I5 J0
+G2 X31 Y15 I3 J0
+G0 Z1
+G0 X0 Y30
+G1 Z-0.2
+G2 X5 Y32 R3
+G2 X10 Y30 R3
+G2 X15 Y32 R3
+G2 X20 Y30 R3
+G2 X25 Y32 R3
+G2 X30 Y30 R3
+G2 X35 Y32 R3
+G2 X40 Y30 R3
+M5
+G0 Z5
+G0 X0 Y0
+M2
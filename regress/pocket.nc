@@ -0,0 +1,66 @@
+(Rectangular pocket, zig-zag clearing plus a finishing pass)
+G21 G90 G17
+M3
+G0 Z5
+G0 Z1
+G0 X0 Y0
+G1 Z-1 F100
+G1 X30 F400
+G1 Y2
+G1 X0
+G1 Y4
+G1 X30
+G1 Y6
+G1 X0
+G1 Y8
+G1 X30
+G1 Y10
+G1 X0
+G1 Y12
+G1 X30
+G1 Y14
+G1 X0
+G1 Y16
+G1 X30
+G1 Y18
+G1 X0
+G1 Y20
+G1 X30
+G1 X0 Y0
+G1 X30
+G1 Y20
+G1 X0
+G1 Y0
+G0 Z1
+G0 X0 Y0
+G1 Z-2 F100
+G1 X30 F400
+G1 Y2
+G1 X0
+G1 Y4
+G1 X30
+G1 Y6
+G1 X0
+G1 Y8
+G1 X30
+G1 Y10
+G1 X0
+G1 Y12
+G1 X30
+G1 Y14
+G1 X0
+G1 Y16
+G1 X30
+G1 Y18
+G1 X0
+G1 Y20
+G1 X30
+G1 X0 Y0
+G1 X30
+G1 Y20
+G1 X0
+G1 Y0
+M5
+G0 Z5
+G0 X0 Y0
+M2
@@ -0,0 +1,74 @@
+#!/bin/sh
+#  Part of Grbl
+#
+#  Grbl is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  Grbl is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+
+# Runs every program in regress/ through the trajectory simulator and compares
+# where it ended up, how many steps it took along each axis and how long it
+# took against the golden results stored next to it (<program>.golden).
+# Endpoints and step counts must match exactly, cycle times to within
+# TOLERANCE percent. With -u, stores the current results as the golden ones
+# instead, do so after checking that a change in cycle time is intended.
+#
+# Usage: regress/run.sh [-u]    (from the top directory, after make sim)
+
+SIM=sim/grbl_sim
+TOLERANCE=${TOLERANCE:-0.1}
+update=false
+[ "$1" = "-u" ] && update=true
+
+failed=0
+summary=$(mktemp) || exit 1
+trap 'rm -f "$summary"' EXIT
+
+printf "%-24s %12s %12s %8s %7s  %s\n" program golden "cycle time" change blocks result
+for program in regress/*.nc; do
+  golden=${program%.nc}.golden
+  errors=$($SIM -r "$summary" < "$program" | grep -c '^error')
+  if [ "$errors" -ne 0 ]; then
+    printf "%-24s %s\n" "$program" "FAIL: $errors lines in error"
+    failed=$((failed + 1))
+    continue
+  fi
+  if $update; then
+    cp "$summary" "$golden"
+    printf "%-24s %12s %11.3fs %8s %7s  %s\n" "$program" - \
+        "$(awk -F, 'NR == 2 { print $1 }' "$summary")" - \
+        "$(awk -F, 'NR == 2 { print $2 }' "$summary")" updated
+    continue
+  fi
+  if [ ! -f "$golden" ]; then
+    printf "%-24s %s\n" "$program" "FAIL: no golden results, run with -u"
+    failed=$((failed + 1))
+    continue
+  fi
+  # time,blocks,x,y,z,steps_x,steps_y,steps_z
+  awk -F, -v program="$program" -v tolerance="$TOLERANCE" '
+    NR == FNR { if(FNR == 2) split($0, golden); next }
+    FNR == 2 {
+      change = golden[1] > 0 ? ($1 - golden[1]) * 100 / golden[1] : 0
+      result = "ok"
+      for(i = 3; i <= 8; i++) if($i != golden[i]) result = "FAIL: endpoint or step count"
+      if(result == "ok" && (change > tolerance || change < -tolerance))
+        result = sprintf("FAIL: cycle time off by more than %g%%", tolerance)
+      printf "%-24s %11.3fs %11.3fs %+7.2f%% %7d  %s\n", program, golden[1], $1,
+          change, $2, result
+      exit(result != "ok")
+    }' "$golden" "$summary" || failed=$((failed + 1))
+done
+
+if [ $failed -ne 0 ]; then
+  echo "$failed program(s) failed"
+  exit 1
+fi
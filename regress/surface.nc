@@ -0,0 +1,461 @@
+(3D surfacing, raster finishing of a sine bump with short segments)
+G21 G90 G17
+M3
+G0 Z5
+G0 X0 Y0
+G1 Z0 F200
+G1 X0.000 Y0.000 Z-2.000 F500
+G1 X0.500 Y0.000 Z-1.800
+G1 X1.000 Y0.000 Z-1.603
+G1 X1.500 Y0.000 Z-1.409
+G1 X2.000 Y0.000 Z-1.221
+G1 X2.500 Y0.000 Z-1.041
+G1 X3.000 Y0.000 Z-0.871
+G1 X3.500 Y0.000 Z-0.712
+G1 X4.000 Y0.000 Z-0.565
+G1 X4.500 Y0.000 Z-0.433
+G1 X5.000 Y0.000 Z-0.317
+G1 X5.500 Y0.000 Z-0.218
+G1 X6.000 Y0.000 Z-0.136
+G1 X6.500 Y0.000 Z-0.073
+G1 X7.000 Y0.000 Z-0.029
+G1 X7.500 Y0.000 Z-0.005
+G1 X8.000 Y0.000 Z-0.001
+G1 X8.500 Y0.000 Z-0.017
+G1 X9.000 Y0.000 Z-0.052
+G1 X9.500 Y0.000 Z-0.107
+G1 X10.000 Y0.000 Z-0.181
+G1 X10.500 Y0.000 Z-0.274
+G1 X11.000 Y0.000 Z-0.383
+G1 X11.500 Y0.000 Z-0.509
+G1 X12.000 Y0.000 Z-0.649
+G1 X12.500 Y0.000 Z-0.803
+G1 X13.000 Y0.000 Z-0.969
+G1 X13.500 Y0.000 Z-1.145
+G1 X14.000 Y0.000 Z-1.330
+G1 X14.500 Y0.000 Z-1.522
+G1 X15.000 Y0.000 Z-1.718
+G1 X15.500 Y0.000 Z-1.917
+G1 X16.000 Y0.000 Z-2.117
+G1 X16.500 Y0.000 Z-2.315
+G1 X17.000 Y0.000 Z-2.511
+G1 X17.500 Y0.000 Z-2.702
+G1 X18.000 Y0.000 Z-2.885
+G1 X18.500 Y0.000 Z-3.060
+G1 X19.000 Y0.000 Z-3.224
+G1 X19.500 Y0.000 Z-3.376
+G1 X20.000 Y0.000 Z-3.514
+G1 X20.000 Y1.000 Z-3.483
+G1 X19.500 Y1.000 Z-3.348
+G1 X19.000 Y1.000 Z-3.199
+G1 X18.500 Y1.000 Z-3.039
+G1 X18.000 Y1.000 Z-2.867
+G1 X17.500 Y1.000 Z-2.688
+G1 X17.000 Y1.000 Z-2.501
+G1 X16.500 Y1.000 Z-2.309
+G1 X16.000 Y1.000 Z-2.114
+G1 X15.500 Y1.000 Z-1.918
+G1 X15.000 Y1.000 Z-1.723
+G1 X14.500 Y1.000 Z-1.531
+G1 X14.000 Y1.000 Z-1.343
+G1 X13.500 Y1.000 Z-1.162
+G1 X13.000 Y1.000 Z-0.990
+G1 X12.500 Y1.000 Z-0.827
+G1 X12.000 Y1.000 Z-0.676
+G1 X11.500 Y1.000 Z-0.538
+G1 X11.000 Y1.000 Z-0.415
+G1 X10.500 Y1.000 Z-0.308
+G1 X10.000 Y1.000 Z-0.218
+G1 X9.500 Y1.000 Z-0.145
+G1 X9.000 Y1.000 Z-0.091
+G1 X8.500 Y1.000 Z-0.056
+G1 X8.000 Y1.000 Z-0.041
+G1 X7.500 Y1.000 Z-0.045
+G1 X7.000 Y1.000 Z-0.068
+G1 X6.500 Y1.000 Z-0.111
+G1 X6.000 Y1.000 Z-0.173
+G1 X5.500 Y1.000 Z-0.253
+G1 X5.000 Y1.000 Z-0.351
+G1 X4.500 Y1.000 Z-0.465
+G1 X4.000 Y1.000 Z-0.594
+G1 X3.500 Y1.000 Z-0.737
+G1 X3.000 Y1.000 Z-0.893
+G1 X2.500 Y1.000 Z-1.060
+G1 X2.000 Y1.000 Z-1.237
+G1 X1.500 Y1.000 Z-1.421
+G1 X1.000 Y1.000 Z-1.611
+G1 X0.500 Y1.000 Z-1.804
+G1 X0.000 Y1.000 Z-2.000
+G1 X0.000 Y2.000 Z-2.000
+G1 X0.500 Y2.000 Z-1.816
+G1 X1.000 Y2.000 Z-1.634
+G1 X1.500 Y2.000 Z-1.456
+G1 X2.000 Y2.000 Z-1.283
+G1 X2.500 Y2.000 Z-1.117
+G1 X3.000 Y2.000 Z-0.960
+G1 X3.500 Y2.000 Z-0.813
+G1 X4.000 Y2.000 Z-0.679
+G1 X4.500 Y2.000 Z-0.557
+G1 X5.000 Y2.000 Z-0.450
+G1 X5.500 Y2.000 Z-0.358
+G1 X6.000 Y2.000 Z-0.283
+G1 X6.500 Y2.000 Z-0.225
+G1 X7.000 Y2.000 Z-0.185
+G1 X7.500 Y2.000 Z-0.162
+G1 X8.000 Y2.000 Z-0.159
+G1 X8.500 Y2.000 Z-0.173
+G1 X9.000 Y2.000 Z-0.206
+G1 X9.500 Y2.000 Z-0.257
+G1 X10.000 Y2.000 Z-0.325
+G1 X10.500 Y2.000 Z-0.410
+G1 X11.000 Y2.000 Z-0.511
+G1 X11.500 Y2.000 Z-0.626
+G1 X12.000 Y2.000 Z-0.756
+G1 X12.500 Y2.000 Z-0.898
+G1 X13.000 Y2.000 Z-1.050
+G1 X13.500 Y2.000 Z-1.213
+G1 X14.000 Y2.000 Z-1.383
+G1 X14.500 Y2.000 Z-1.559
+G1 X15.000 Y2.000 Z-1.740
+G1 X15.500 Y2.000 Z-1.923
+G1 X16.000 Y2.000 Z-2.108
+G1 X16.500 Y2.000 Z-2.291
+G1 X17.000 Y2.000 Z-2.471
+G1 X17.500 Y2.000 Z-2.646
+G1 X18.000 Y2.000 Z-2.815
+G1 X18.500 Y2.000 Z-2.976
+G1 X19.000 Y2.000 Z-3.127
+G1 X19.500 Y2.000 Z-3.267
+G1 X20.000 Y2.000 Z-3.394
+G1 X20.000 Y3.000 Z-3.249
+G1 X19.500 Y3.000 Z-3.135
+G1 X19.000 Y3.000 Z-3.010
+G1 X18.500 Y3.000 Z-2.875
+G1 X18.000 Y3.000 Z-2.730
+G1 X17.500 Y3.000 Z-2.579
+G1 X17.000 Y3.000 Z-2.422
+G1 X16.500 Y3.000 Z-2.260
+G1 X16.000 Y3.000 Z-2.096
+G1 X15.500 Y3.000 Z-1.931
+G1 X15.000 Y3.000 Z-1.767
+G1 X14.500 Y3.000 Z-1.605
+G1 X14.000 Y3.000 Z-1.447
+G1 X13.500 Y3.000 Z-1.295
+G1 X13.000 Y3.000 Z-1.149
+G1 X12.500 Y3.000 Z-1.012
+G1 X12.000 Y3.000 Z-0.885
+G1 X11.500 Y3.000 Z-0.769
+G1 X11.000 Y3.000 Z-0.665
+G1 X10.500 Y3.000 Z-0.575
+G1 X10.000 Y3.000 Z-0.499
+G1 X9.500 Y3.000 Z-0.438
+G1 X9.000 Y3.000 Z-0.392
+G1 X8.500 Y3.000 Z-0.363
+G1 X8.000 Y3.000 Z-0.350
+G1 X7.500 Y3.000 Z-0.353
+G1 X7.000 Y3.000 Z-0.373
+G1 X6.500 Y3.000 Z-0.409
+G1 X6.000 Y3.000 Z-0.462
+G1 X5.500 Y3.000 Z-0.529
+G1 X5.000 Y3.000 Z-0.611
+G1 X4.500 Y3.000 Z-0.707
+G1 X4.000 Y3.000 Z-0.816
+G1 X3.500 Y3.000 Z-0.937
+G1 X3.000 Y3.000 Z-1.068
+G1 X2.500 Y3.000 Z-1.209
+G1 X2.000 Y3.000 Z-1.357
+G1 X1.500 Y3.000 Z-1.512
+G1 X1.000 Y3.000 Z-1.672
+G1 X0.500 Y3.000 Z-1.835
+G1 X0.000 Y3.000 Z-2.000
+G1 X0.000 Y4.000 Z-2.000
+G1 X0.500 Y4.000 Z-1.861
+G1 X1.000 Y4.000 Z-1.723
+G1 X1.500 Y4.000 Z-1.588
+G1 X2.000 Y4.000 Z-1.457
+G1 X2.500 Y4.000 Z-1.332
+G1 X3.000 Y4.000 Z-1.213
+G1 X3.500 Y4.000 Z-1.102
+G1 X4.000 Y4.000 Z-1.000
+G1 X4.500 Y4.000 Z-0.909
+G1 X5.000 Y4.000 Z-0.827
+G1 X5.500 Y4.000 Z-0.758
+G1 X6.000 Y4.000 Z-0.701
+G1 X6.500 Y4.000 Z-0.657
+G1 X7.000 Y4.000 Z-0.627
+G1 X7.500 Y4.000 Z-0.610
+G1 X8.000 Y4.000 Z-0.607
+G1 X8.500 Y4.000 Z-0.618
+G1 X9.000 Y4.000 Z-0.643
+G1 X9.500 Y4.000 Z-0.681
+G1 X10.000 Y4.000 Z-0.733
+G1 X10.500 Y4.000 Z-0.797
+G1 X11.000 Y4.000 Z-0.873
+G1 X11.500 Y4.000 Z-0.961
+G1 X12.000 Y4.000 Z-1.059
+G1 X12.500 Y4.000 Z-1.166
+G1 X13.000 Y4.000 Z-1.282
+G1 X13.500 Y4.000 Z-1.404
+G1 X14.000 Y4.000 Z-1.533
+G1 X14.500 Y4.000 Z-1.667
+G1 X15.000 Y4.000 Z-1.803
+G1 X15.500 Y4.000 Z-1.942
+G1 X16.000 Y4.000 Z-2.081
+G1 X16.500 Y4.000 Z-2.220
+G1 X17.000 Y4.000 Z-2.356
+G1 X17.500 Y4.000 Z-2.489
+G1 X18.000 Y4.000 Z-2.617
+G1 X18.500 Y4.000 Z-2.738
+G1 X19.000 Y4.000 Z-2.853
+G1 X19.500 Y4.000 Z-2.958
+G1 X20.000 Y4.000 Z-3.055
+G1 X20.000 Y5.000 Z-2.818
+G1 X19.500 Y5.000 Z-2.743
+G1 X19.000 Y5.000 Z-2.661
+G1 X18.500 Y5.000 Z-2.573
+G1 X18.000 Y5.000 Z-2.478
+G1 X17.500 Y5.000 Z-2.379
+G1 X17.000 Y5.000 Z-2.276
+G1 X16.500 Y5.000 Z-2.170
+G1 X16.000 Y5.000 Z-2.063
+G1 X15.500 Y5.000 Z-1.955
+G1 X15.000 Y5.000 Z-1.848
+G1 X14.500 Y5.000 Z-1.741
+G1 X14.000 Y5.000 Z-1.638
+G1 X13.500 Y5.000 Z-1.538
+G1 X13.000 Y5.000 Z-1.443
+G1 X12.500 Y5.000 Z-1.353
+G1 X12.000 Y5.000 Z-1.270
+G1 X11.500 Y5.000 Z-1.194
+G1 X11.000 Y5.000 Z-1.126
+G1 X10.500 Y5.000 Z-1.067
+G1 X10.000 Y5.000 Z-1.017
+G1 X9.500 Y5.000 Z-0.977
+G1 X9.000 Y5.000 Z-0.948
+G1 X8.500 Y5.000 Z-0.928
+G1 X8.000 Y5.000 Z-0.920
+G1 X7.500 Y5.000 Z-0.922
+G1 X7.000 Y5.000 Z-0.935
+G1 X6.500 Y5.000 Z-0.959
+G1 X6.000 Y5.000 Z-0.993
+G1 X5.500 Y5.000 Z-1.037
+G1 X5.000 Y5.000 Z-1.091
+G1 X4.500 Y5.000 Z-1.154
+G1 X4.000 Y5.000 Z-1.225
+G1 X3.500 Y5.000 Z-1.304
+G1 X3.000 Y5.000 Z-1.390
+G1 X2.500 Y5.000 Z-1.482
+G1 X2.000 Y5.000 Z-1.579
+G1 X1.500 Y5.000 Z-1.681
+G1 X1.000 Y5.000 Z-1.785
+G1 X0.500 Y5.000 Z-1.892
+G1 X0.000 Y5.000 Z-2.000
+G1 X0.000 Y6.000 Z-2.000
+G1 X0.500 Y6.000 Z-1.928
+G1 X1.000 Y6.000 Z-1.856
+G1 X1.500 Y6.000 Z-1.786
+G1 X2.000 Y6.000 Z-1.718
+G1 X2.500 Y6.000 Z-1.653
+G1 X3.000 Y6.000 Z-1.591
+G1 X3.500 Y6.000 Z-1.533
+G1 X4.000 Y6.000 Z-1.480
+G1 X4.500 Y6.000 Z-1.432
+G1 X5.000 Y6.000 Z-1.390
+G1 X5.500 Y6.000 Z-1.354
+G1 X6.000 Y6.000 Z-1.325
+G1 X6.500 Y6.000 Z-1.302
+G1 X7.000 Y6.000 Z-1.286
+G1 X7.500 Y6.000 Z-1.277
+G1 X8.000 Y6.000 Z-1.276
+G1 X8.500 Y6.000 Z-1.281
+G1 X9.000 Y6.000 Z-1.294
+G1 X9.500 Y6.000 Z-1.314
+G1 X10.000 Y6.000 Z-1.341
+G1 X10.500 Y6.000 Z-1.374
+G1 X11.000 Y6.000 Z-1.414
+G1 X11.500 Y6.000 Z-1.460
+G1 X12.000 Y6.000 Z-1.510
+G1 X12.500 Y6.000 Z-1.566
+G1 X13.000 Y6.000 Z-1.626
+G1 X13.500 Y6.000 Z-1.690
+G1 X14.000 Y6.000 Z-1.757
+G1 X14.500 Y6.000 Z-1.827
+G1 X15.000 Y6.000 Z-1.898
+G1 X15.500 Y6.000 Z-1.970
+G1 X16.000 Y6.000 Z-2.042
+G1 X16.500 Y6.000 Z-2.114
+G1 X17.000 Y6.000 Z-2.185
+G1 X17.500 Y6.000 Z-2.254
+G1 X18.000 Y6.000 Z-2.321
+G1 X18.500 Y6.000 Z-2.384
+G1 X19.000 Y6.000 Z-2.443
+G1 X19.500 Y6.000 Z-2.498
+G1 X20.000 Y6.000 Z-2.548
+G1 X20.000 Y7.000 Z-2.257
+G1 X19.500 Y7.000 Z-2.234
+G1 X19.000 Y7.000 Z-2.208
+G1 X18.500 Y7.000 Z-2.180
+G1 X18.000 Y7.000 Z-2.150
+G1 X17.500 Y7.000 Z-2.119
+G1 X17.000 Y7.000 Z-2.087
+G1 X16.500 Y7.000 Z-2.054
+G1 X16.000 Y7.000 Z-2.020
+G1 X15.500 Y7.000 Z-1.986
+G1 X15.000 Y7.000 Z-1.952
+G1 X14.500 Y7.000 Z-1.919
+G1 X14.000 Y7.000 Z-1.886
+G1 X13.500 Y7.000 Z-1.855
+G1 X13.000 Y7.000 Z-1.825
+G1 X12.500 Y7.000 Z-1.797
+G1 X12.000 Y7.000 Z-1.770
+G1 X11.500 Y7.000 Z-1.747
+G1 X11.000 Y7.000 Z-1.725
+G1 X10.500 Y7.000 Z-1.707
+G1 X10.000 Y7.000 Z-1.691
+G1 X9.500 Y7.000 Z-1.678
+G1 X9.000 Y7.000 Z-1.669
+G1 X8.500 Y7.000 Z-1.663
+G1 X8.000 Y7.000 Z-1.660
+G1 X7.500 Y7.000 Z-1.661
+G1 X7.000 Y7.000 Z-1.665
+G1 X6.500 Y7.000 Z-1.672
+G1 X6.000 Y7.000 Z-1.683
+G1 X5.500 Y7.000 Z-1.697
+G1 X5.000 Y7.000 Z-1.714
+G1 X4.500 Y7.000 Z-1.734
+G1 X4.000 Y7.000 Z-1.756
+G1 X3.500 Y7.000 Z-1.781
+G1 X3.000 Y7.000 Z-1.808
+G1 X2.500 Y7.000 Z-1.837
+G1 X2.000 Y7.000 Z-1.868
+G1 X1.500 Y7.000 Z-1.900
+G1 X1.000 Y7.000 Z-1.932
+G1 X0.500 Y7.000 Z-1.966
+G1 X0.000 Y7.000 Z-2.000
+G1 X0.000 Y8.000 Z-2.000
+G1 X0.500 Y8.000 Z-2.006
+G1 X1.000 Y8.000 Z-2.012
+G1 X1.500 Y8.000 Z-2.017
+G1 X2.000 Y8.000 Z-2.023
+G1 X2.500 Y8.000 Z-2.028
+G1 X3.000 Y8.000 Z-2.033
+G1 X3.500 Y8.000 Z-2.038
+G1 X4.000 Y8.000 Z-2.042
+G1 X4.500 Y8.000 Z-2.046
+G1 X5.000 Y8.000 Z-2.049
+G1 X5.500 Y8.000 Z-2.052
+G1 X6.000 Y8.000 Z-2.054
+G1 X6.500 Y8.000 Z-2.056
+G1 X7.000 Y8.000 Z-2.058
+G1 X7.500 Y8.000 Z-2.058
+G1 X8.000 Y8.000 Z-2.058
+G1 X8.500 Y8.000 Z-2.058
+G1 X9.000 Y8.000 Z-2.057
+G1 X9.500 Y8.000 Z-2.055
+G1 X10.000 Y8.000 Z-2.053
+G1 X10.500 Y8.000 Z-2.050
+G1 X11.000 Y8.000 Z-2.047
+G1 X11.500 Y8.000 Z-2.044
+G1 X12.000 Y8.000 Z-2.039
+G1 X12.500 Y8.000 Z-2.035
+G1 X13.000 Y8.000 Z-2.030
+G1 X13.500 Y8.000 Z-2.025
+G1 X14.000 Y8.000 Z-2.020
+G1 X14.500 Y8.000 Z-2.014
+G1 X15.000 Y8.000 Z-2.008
+G1 X15.500 Y8.000 Z-2.002
+G1 X16.000 Y8.000 Z-1.997
+G1 X16.500 Y8.000 Z-1.991
+G1 X17.000 Y8.000 Z-1.985
+G1 X17.500 Y8.000 Z-1.980
+G1 X18.000 Y8.000 Z-1.974
+G1 X18.500 Y8.000 Z-1.969
+G1 X19.000 Y8.000 Z-1.964
+G1 X19.500 Y8.000 Z-1.960
+G1 X20.000 Y8.000 Z-1.956
+G1 X20.000 Y9.000 Z-1.656
+G1 X19.500 Y9.000 Z-1.687
+G1 X19.000 Y9.000 Z-1.722
+G1 X18.500 Y9.000 Z-1.759
+G1 X18.000 Y9.000 Z-1.799
+G1 X17.500 Y9.000 Z-1.841
+G1 X17.000 Y9.000 Z-1.884
+G1 X16.500 Y9.000 Z-1.928
+G1 X16.000 Y9.000 Z-1.973
+G1 X15.500 Y9.000 Z-2.019
+G1 X15.000 Y9.000 Z-2.064
+G1 X14.500 Y9.000 Z-2.109
+G1 X14.000 Y9.000 Z-2.152
+G1 X13.500 Y9.000 Z-2.194
+G1 X13.000 Y9.000 Z-2.234
+G1 X12.500 Y9.000 Z-2.272
+G1 X12.000 Y9.000 Z-2.307
+G1 X11.500 Y9.000 Z-2.339
+G1 X11.000 Y9.000 Z-2.367
+G1 X10.500 Y9.000 Z-2.392
+G1 X10.000 Y9.000 Z-2.413
+G1 X9.500 Y9.000 Z-2.430
+G1 X9.000 Y9.000 Z-2.443
+G1 X8.500 Y9.000 Z-2.451
+G1 X8.000 Y9.000 Z-2.454
+G1 X7.500 Y9.000 Z-2.453
+G1 X7.000 Y9.000 Z-2.448
+G1 X6.500 Y9.000 Z-2.438
+G1 X6.000 Y9.000 Z-2.424
+G1 X5.500 Y9.000 Z-2.405
+G1 X5.000 Y9.000 Z-2.382
+G1 X4.500 Y9.000 Z-2.356
+G1 X4.000 Y9.000 Z-2.326
+G1 X3.500 Y9.000 Z-2.293
+G1 X3.000 Y9.000 Z-2.257
+G1 X2.500 Y9.000 Z-2.218
+G1 X2.000 Y9.000 Z-2.177
+G1 X1.500 Y9.000 Z-2.134
+G1 X1.000 Y9.000 Z-2.090
+G1 X0.500 Y9.000 Z-2.045
+G1 X0.000 Y9.000 Z-2.000
+G1 X0.000 Y10.000 Z-2.000
+G1 X0.500 Y10.000 Z-2.083
+G1 X1.000 Y10.000 Z-2.165
+G1 X1.500 Y10.000 Z-2.246
+G1 X2.000 Y10.000 Z-2.324
+G1 X2.500 Y10.000 Z-2.399
+G1 X3.000 Y10.000 Z-2.470
+G1 X3.500 Y10.000 Z-2.536
+G1 X4.000 Y10.000 Z-2.597
+G1 X4.500 Y10.000 Z-2.652
+G1 X5.000 Y10.000 Z-2.700
+G1 X5.500 Y10.000 Z-2.742
+G1 X6.000 Y10.000 Z-2.776
+G1 X6.500 Y10.000 Z-2.802
+G1 X7.000 Y10.000 Z-2.820
+G1 X7.500 Y10.000 Z-2.830
+G1 X8.000 Y10.000 Z-2.832
+G1 X8.500 Y10.000 Z-2.825
+G1 X9.000 Y10.000 Z-2.811
+G1 X9.500 Y10.000 Z-2.788
+G1 X10.000 Y10.000 Z-2.757
+G1 X10.500 Y10.000 Z-2.718
+G1 X11.000 Y10.000 Z-2.673
+G1 X11.500 Y10.000 Z-2.621
+G1 X12.000 Y10.000 Z-2.562
+G1 X12.500 Y10.000 Z-2.498
+G1 X13.000 Y10.000 Z-2.429
+G1 X13.500 Y10.000 Z-2.356
+G1 X14.000 Y10.000 Z-2.279
+G1 X14.500 Y10.000 Z-2.199
+G1 X15.000 Y10.000 Z-2.117
+G1 X15.500 Y10.000 Z-2.035
+G1 X16.000 Y10.000 Z-1.951
+G1 X16.500 Y10.000 Z-1.869
+G1 X17.000 Y10.000 Z-1.787
+G1 X17.500 Y10.000 Z-1.708
+G1 X18.000 Y10.000 Z-1.632
+G1 X18.500 Y10.000 Z-1.559
+G1 X19.000 Y10.000 Z-1.491
+G1 X19.500 Y10.000 Z-1.428
+G1 X20.000 Y10.000 Z-1.370
+M5
+G0 Z5
+G0 X0 Y0
+M2
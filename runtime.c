@@ -25,6 +25,7 @@
 #include "config.h"
 
 #include "nuts_bolts.h"
+#include "protocol.h"
 #include "settings.h"
 #include "stepper.h"
 
@@ -37,6 +38,7 @@
 // set the system runtime flags, where only the main program handles them, removing the need to
 // define more computationally-expensive volatile variables.
 void execute_runtime() {
+  host_idle(); // Lets hosts without real interrupts catch up on them
   if (sys.execute) { // Enter only if any bit flag is true
     uint8_t rt_exec = sys.execute; // Avoid calling volatile multiple times
   
@@ -66,5 +68,10 @@ void execute_runtime() {
       #endif
       bit_false(sys.execute, EXEC_CYCLE_START);
     } 
+
+    // Execute and serial print status. Clears its own flag once the whole report is out.
+    if (rt_exec & EXEC_STATUS_REPORT) {
+      protocol_status_report();
+    }
   }
 }  
@@ -0,0 +1,29 @@
+"""\
+Grbl's startup banner, shared by the streaming scripts
+
+Grbl announces itself after every reset with a line like
+
+    Grbl 0.8b [RX:128,TX:64,BAUD:9600]
+
+followed by a hint on '$'. The sizes tell a streaming script how much it may
+keep in flight.
+"""
+
+import re
+import time
+
+
+BANNER = re.compile(r"\[RX:(\d+),TX:(\d+),BAUD:(\d+)\]")
+
+def readBanner(s, timeout=2):
+    """Waits for grbl's startup banner, returns its Rx buffer size or None
+
+    Returns as soon as the banner has been read, with the line after it, so
+    that nothing of it is left to be taken for a response."""
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        m = BANNER.search(s.readline())
+        if m:
+            s.readline() # "'$' to dump current settings"
+            return int(m.group(1))
+    return None
@@ -0,0 +1,267 @@
+(Binary protocol check, see make -f Makefile.i386 binary-check)
+(Frames holding 0xFF bytes, which must get through like any other)
+G21 G90 G94
+(X is ff ff ff 3f, then ff ff ff bf)
+G1 X1.99999988 F500
+G1 X-1.99999988
+G1 X0
+(CRC is ff 1c)
+G1 X4 Y1 F543
+(Enough frames for SEQ to get to 0xFF and wrap around)
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G1 X5 Y2
+G1 X4 Y1
+G0 X0 Y0
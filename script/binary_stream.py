@@ -0,0 +1,258 @@
+#!/usr/bin/env python
+"""\
+Stream g-code to grbl controller using the binary protocol
+
+Converts a simple g-code program into binary protocol frames (see
+binary_protocol.h, grbl needs to be built with BINARY_PROTOCOL) and streams
+them, keeping as many frames in grbl's serial read buffer as fit. Only what
+maps onto frames is understood: G0, G1, G2, G3 (I/J/K arcs), G4, G17-G19,
+G20/G21, G90/G91, G93/G94, F, M3-M5 and M7-M9, with no work offsets in effect.
+Anything else is reported and the program refused before a byte is sent.
+
+With --output, frames are written to a file instead, e.g. for feeding a host
+build of grbl. With --check, what that host build answered is checked against
+the frames instead: every one must have been acknowledged, in order, with ok.
+
+A frame grbl received garbled is answered with "bad frame" and the sequence
+number of the last good one, everything after that is resent.
+"""
+
+from collections import deque
+import argparse
+import re
+import struct
+import sys
+import time
+
+from banner import readBanner
+
+
+# Only used if grbl's startup banner doesn't tell, make sure this is in sync
+# with CONSOLE_RXBUF_SIZE in host.h then
+RX_BUFFER_SIZE = 128
+# Make sure this is in sync with CONSOLE_BAUD_RATE in host.h (or use --baud)
+BAUD_RATE = 9600
+
+# Make sure these are in sync with binary_protocol.h
+SYNC = 0xA5
+CMD_LINE, CMD_ARC, CMD_DWELL, CMD_SETTING, CMD_IO = 0x01, 0x02, 0x03, 0x04, 0x05
+CMD_REALTIME = 0x06
+CMD_ACK = 0x80
+STATUS_BAD_FRAME = 7
+MAX_RESENDS = 10 # In a row, before giving up on the serial link
+FLAG_F, FLAG_RAPID, FLAG_INVERSE, FLAG_CW = 0x08, 0x10, 0x20, 0x10
+PLANES = {17: 0x00, 18: 0x40, 19: 0x80}
+PLANE_AXES = {17: (0, 1), 18: (0, 2), 19: (1, 2)}
+IO_SPINDLE, IO_COOLANT = 0x00, 0x01
+COOLANT_FLOOD, COOLANT_MIST = 0x01, 0x02
+
+STATUS = ["ok", "Bad number format", "Expected command letter",
+    "Unsupported statement", "Floating point error", "Modal group violation",
+    "Invalid command", "Bad frame"]
+
+def crc16(data, crc=0xFFFF):
+    """Same as AVR's _crc16_update(), i.e. host_crc16()"""
+    for c in data:
+        crc ^= ord(c)
+        for i in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+def frame(seq, command, payload):
+    body = struct.pack("<BBB", len(payload), seq & 0xFF, command) + payload
+    return chr(SYNC) + body + struct.pack("<H", crc16(body))
+
+class Converter:
+    """Turns g-code blocks into (command, payload) pairs"""
+
+    def __init__(self):
+        self.position = [0.0, 0.0, 0.0]
+        self.motion = 0
+        self.plane = 17
+        self.scale = 1.0
+        self.absolute = True
+        self.inverse = False
+        self.coolant = 0
+
+    def convert(self, line):
+        line = re.sub(r"\(.*?\)|;.*", "", line).upper().replace(" ", "")
+        words = re.findall(r"([A-Z])([-+]?[0-9]*\.?[0-9]*)", line)
+        if "".join(l + v for l, v in words) != line:
+            raise ValueError("cannot parse")
+        values, frames, dwell = {}, [], None
+        for letter, value in words:
+            value = float(value)
+            if letter == "G":
+                if value in (0, 1, 2, 3): self.motion = int(value)
+                elif value == 4: dwell = True
+                elif value in (17, 18, 19): self.plane = int(value)
+                elif value in (20, 21): self.scale = 25.4 if value == 20 else 1.0
+                elif value in (90, 91): self.absolute = value == 90
+                elif value in (93, 94): self.inverse = value == 93
+                else: raise ValueError("unsupported G%g" % value)
+            elif letter == "M":
+                if value in (3, 4, 5):
+                    frames.append((CMD_IO, struct.pack("<Bb", IO_SPINDLE,
+                        {3: 1, 4: -1, 5: 0}[value])))
+                elif value in (7, 8, 9):
+                    self.coolant = {7: self.coolant | COOLANT_MIST,
+                        8: self.coolant | COOLANT_FLOOD, 9: 0}[value]
+                    frames.append((CMD_IO, struct.pack("<BB", IO_COOLANT,
+                        self.coolant)))
+                else: raise ValueError("unsupported M%g" % value)
+            elif letter in "XYZIJKFP":
+                values[letter] = value
+            elif letter != "N":
+                raise ValueError("unsupported word %s" % letter)
+        if dwell:
+            frames.append((CMD_DWELL, struct.pack("<f", values.get("P", 0))))
+        elif any(l in values for l in "XYZ") or (self.motion >= 2 and
+                any(l in values for l in "IJK")):
+            frames.append(self.move(values))
+        return frames
+
+    def move(self, values):
+        flags, floats = 0, []
+        for i, letter in enumerate("XYZ"):
+            if letter in values:
+                target = values[letter] * self.scale
+                if not self.absolute: target += self.position[i]
+                self.position[i] = target
+                flags |= 1 << i
+                floats.append(target)
+        if self.motion >= 2:
+            offsets = dict(zip("IJK", [values.get(l, 0) * self.scale
+                for l in "IJK"]))
+            floats.extend(offsets["IJK"[i]] for i in PLANE_AXES[self.plane])
+            flags |= PLANES[self.plane] | (FLAG_CW if self.motion == 2 else 0)
+        if self.motion != 0 and "F" in values:
+            flags |= FLAG_F
+            floats.append(values["F"] * (1.0 if self.inverse else self.scale))
+        if self.motion == 0: flags |= FLAG_RAPID
+        elif self.inverse: flags |= FLAG_INVERSE
+        return (CMD_ARC if self.motion >= 2 else CMD_LINE,
+            struct.pack("<B%df" % len(floats), flags, *floats))
+
+def readAck(s, echo=True):
+    """Returns (seq, status) of the next ack, skipping any text in between"""
+    while True:
+        c = s.read(1)
+        if not c: return None
+        if ord(c) != SYNC:
+            if echo and c not in "\r\n": sys.stdout.write(c)
+            continue
+        body = s.read(6)
+        if len(body) < 6 or ord(body[0]) != 1 or ord(body[2]) != CMD_ACK:
+            continue
+        if struct.unpack("<H", body[4:6])[0] != crc16(body[:4]):
+            continue
+        return ord(body[1]), ord(body[3])
+
+# Define command line argument interface
+parser = argparse.ArgumentParser(description="Stream a G-Code file to grbl "
+    "as binary frames. The size of grbl's Rx buffer is taken from its startup "
+    "banner, assuming %d bytes if there is none." % RX_BUFFER_SIZE)
+parser.add_argument("gcode_file", type=argparse.FileType("r"),
+    help="filename of RS274NGC part program to be converted")
+parser.add_argument("device_file", nargs="?", help="serial port to stream "
+    "to (e.g. /dev/ttyS0)")
+parser.add_argument("-o", "--output", type=argparse.FileType("wb"),
+    help="write the frames to this file instead of streaming them")
+parser.add_argument("-c", "--check", type=argparse.FileType("rb"),
+    help="check the acknowledgements a host build wrote to this file, "
+    "after being fed the frames written with --output")
+parser.add_argument("-b", "--baud", type=int, default=BAUD_RATE,
+    help="serial port speed, must match CONSOLE_BAUD_RATE (default %d)" %
+    BAUD_RATE)
+args = parser.parse_args()
+if not args.device_file and not args.output and not args.check:
+    parser.error("need either a device to stream to, an output file or "
+        "acknowledgements to check")
+
+# Convert the whole program first, so that nothing moves if part of it can't
+# be converted
+converter = Converter()
+frames = []
+for number, line in enumerate(args.gcode_file, 1):
+    try:
+        for command, payload in converter.convert(line.strip()):
+            frames.append(frame(len(frames), command, payload))
+    except ValueError as e:
+        sys.exit("%s:%d: %s: %s" % (args.gcode_file.name, number, e,
+            line.strip()))
+total = sum(len(f) for f in frames)
+print "%d frames, %d bytes" % (len(frames), total)
+
+if args.output:
+    args.output.write("".join(frames))
+    sys.exit(0)
+
+if args.check:
+    for number, f in enumerate(frames):
+        ack = readAck(args.check, False)
+        if ack is None: sys.exit("\nFrame %d: no acknowledgement" % number)
+        if ack != (ord(f[2]), 0):
+            sys.exit("\nFrame %d: acknowledged as frame %d, %s" % (number,
+                ack[0], STATUS[ack[1]] if ack[1] < len(STATUS) else ack[1]))
+    if readAck(args.check, False) is not None: sys.exit("\nMore acknowledgements "
+        "than frames")
+    print "All %d frames acknowledged" % len(frames)
+    sys.exit(0)
+
+import serial
+s = serial.Serial(args.device_file, args.baud, timeout=0.5)
+
+# Wake up grbl. Opening the port resets most boards, if this one didn't reset
+# ask grbl to, so that we get to see the startup banner. A plain ^X would be
+# ignored if grbl has seen frames since its last reset.
+print "Initializing grbl..."
+s.write("\r\n\r\n")
+rx_size = readBanner(s)
+if rx_size is None:
+    s.write(frame(0, CMD_REALTIME, "\x18"))
+    rx_size = readBanner(s)
+if rx_size is None:
+    print "No startup banner, assuming a %d bytes Rx buffer" % RX_BUFFER_SIZE
+else:
+    RX_BUFFER_SIZE = rx_size
+s.flushInput()
+s.timeout = 5
+
+# Stream frames to grbl, as many as fit in its Rx buffer. Acks come in order.
+in_flight = deque() # Indices into frames
+start = time.time()
+sent = resends = 0
+while sent < len(frames) or in_flight:
+    if (sent < len(frames) and not s.inWaiting() and sum(len(frames[i])
+            for i in in_flight) + len(frames[sent]) <= RX_BUFFER_SIZE):
+        s.write(frames[sent])
+        in_flight.append(sent)
+        sent += 1
+        continue
+    ack = readAck(s)
+    if ack is None:
+        sys.exit("\nTimed out waiting for an acknowledgement")
+    oldest = in_flight[0]
+    if ack == ((oldest - 1) & 0xFF, STATUS_BAD_FRAME):
+        # Garbled on the way, grbl drops whatever else is in flight. Give it
+        # time to, then resend from the oldest one.
+        resends += 1
+        if resends > MAX_RESENDS:
+            sys.exit("\nFrame %d: garbled %d times in a row" % (oldest,
+                resends))
+        print "\nFrame %d garbled, resending" % oldest
+        time.sleep(sum(len(frames[i]) for i in in_flight) * 10.0 / args.baud)
+        in_flight.clear()
+        sent = oldest
+        continue
+    if ack[0] != ord(frames[oldest][2]) or ack[1]:
+        sys.exit("\nFrame %d: %s" % (ack[0], STATUS[ack[1]]
+            if ack[1] < len(STATUS) else ack[1]))
+    in_flight.popleft()
+    resends = 0
+
+print "Streamed %d bytes in %.1fs" % (total, time.time() - start)
+print ("WARNING: Moves may still be buffered in grbl, wait until all CNC "
+    "movement stops before powering down and/or touching the machine or "
+    "workpiece.")
+s.close()
@@ -0,0 +1,26 @@
+(Standard move set for measuring step interrupt timing, see STEPPER_ISR_TIMING)
+(Stream it, wait for motion to finish, then send $I to read the figures)
+(NOTE: kept under BLOCK_BUFFER_SIZE moves so that it also runs on host builds)
+G21 G90 G94
+G92 X0 Y0 Z0
+(Single axis moves, slow and at seek rate)
+G1 X10 F100
+G0 X0
+G0 Y10
+G0 Z5
+G0 Y0 Z0
+(Three axis diagonals, all Bresenham counters stepping)
+G1 X20 Y15 Z3 F2000
+G1 X0 Y0 Z0
+(Short segments with junctions, back to back accel/decel ticks)
+G1 X1 Y0.5 F1500
+G1 X2 Y0
+G1 X3 Y0.5
+G1 X4 Y0
+G1 X5 Y0.5
+G1 X6 Y0
+(Feed rate changes mid stream)
+G1 X30 F3000
+G1 X40 F300
+G1 X50 F6000
+G0 X0 Y0 Z0
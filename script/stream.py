@@ -14,16 +14,19 @@ Originally by Sungeun K. Jeon
 
 from collections import defaultdict, deque
 import argparse
+import re
 import serial
 import sys
-import time
 
+from banner import readBanner
 
-# Make sure this is in sync with CONSOLE_RXBUF_SIZE in host.h, otherwise the
-# whole code here is useless
+
+# Only used if grbl's startup banner doesn't tell, make sure this is in sync
+# with CONSOLE_RXBUF_SIZE in host.h then, otherwise the whole code here is
+# useless
 RX_BUFFER_SIZE = 128
-# Make sure this is in sync with CONSOLE_BAUD_RATE in host.h, otherwise this
-# won't be able to talk to grbl
+# Make sure this is in sync with CONSOLE_BAUD_RATE in host.h (or use --baud),
+# otherwise this won't be able to talk to grbl
 BAUD_RATE = 9600
 
 def waitOnInputOrBuffer(watermark, stats=False, line=""):
@@ -36,6 +39,16 @@ def waitOnInputOrBuffer(watermark, stats=False, line=""):
         else:
             g_count += 1 # Count processed lines
             c_line.popleft()
+            # grbl built with REPORT_RX_FREE says how much of its Rx buffer is
+            # free, before reading on. Whatever it holds by then must be part
+            # of the lines still unacknowledged, or we've lost count.
+            m = re.match(r"ok:(\d+)$", out_temp)
+            if m and c_line:
+                held = RX_BUFFER_SIZE - 1 - int(m.group(1))
+                if held > sum(c_line):
+                    print "\nDebug: Rx buffer count off by %d bytes" % (
+                        held - sum(c_line))
+                    c_line[-1] += held - sum(c_line)
             if stats:
                 progressStatsOutput(line)
 
@@ -47,32 +60,42 @@ def progressStatsOutput(line):
 
 # Define command line argument interface
 parser = argparse.ArgumentParser(description="Stream a G-Code file to grbl. "
-    "This version assumes the serial port speed is %d baud and grbl's Rx "
-    "buffer is %d bytes deep." % (BAUD_RATE, RX_BUFFER_SIZE))
+    "The size of grbl's Rx buffer is taken from its startup banner, assuming "
+    "%d bytes if there is none." % RX_BUFFER_SIZE)
 parser.add_argument("gcode_file", type=argparse.FileType("r"),
     help="filename of RS274NGC part program to be streamed")
 parser.add_argument("device_file", help="serial port to stream to (e.g. "
     "/dev/ttyS0)")
 parser.add_argument("-q","--quiet",action="store_true", default=False, 
     help="suppress progress statistics to console")
+parser.add_argument("-b", "--baud", type=int, default=BAUD_RATE,
+    help="serial port speed, must match CONSOLE_BAUD_RATE (default %d)" %
+    BAUD_RATE)
 args = parser.parse_args()
 
 # Initialize
-s = serial.Serial(args.device_file, BAUD_RATE)
+s = serial.Serial(args.device_file, args.baud, timeout=0.5)
 f = args.gcode_file
 verbose = not args.quiet
 
-# Wake up grbl
+# Wake up grbl. Opening the port resets most boards, if this one didn't reset
+# ask grbl to, so that we get to see the startup banner.
 print "Initializing grbl..."
 s.write("\r\n\r\n")
-
-# Wait for grbl to initialize and flush startup text in serial input
-time.sleep(2)
+rx_size = readBanner(s)
+if rx_size is None:
+    s.write("\x18")
+    rx_size = readBanner(s)
+if rx_size is None:
+    print "No startup banner, assuming a %d bytes Rx buffer" % RX_BUFFER_SIZE
+else:
+    RX_BUFFER_SIZE = rx_size
 s.flushInput()
+s.timeout = None
 
 # Stream G-Code to grbl
-print "Streaming %s to %s at %d baud assuming a %d bytes Rx buffer" % (
-    args.gcode_file.name, args.device_file, BAUD_RATE, RX_BUFFER_SIZE)
+print "Streaming %s to %s at %d baud with a %d bytes Rx buffer" % (
+    args.gcode_file.name, args.device_file, args.baud, RX_BUFFER_SIZE)
 l_count = 0
 g_count = 0
 # This being Python, it's acceptable to use a queue instead of a register
@@ -0,0 +1,125 @@
+#!/usr/bin/env python
+"""\
+Decode a binary trace recorded by a host build of grbl
+
+A host build run with -t <file> records every pin change, timer change and
+interrupt into <file> with its virtual time stamp (see host-i386-private.h).
+This prints them back as text, the way the host HAL logs them, or just a
+summary of how many of each there were.
+"""
+
+import argparse
+import mmap
+import struct
+import sys
+
+
+# Make sure these are in sync with host-i386-private.h and host-i386.h
+HEADER = struct.Struct("<8sHHI")
+RECORD = struct.Struct("<QIBBBx")
+MAGIC = "GRBLTRC"
+VERSION = 1
+(GPIO_WRITE, GPIO_DIRECTION, INTERRUPTS, VECTOR_ENTER, VECTOR_EXIT,
+    INTERRUPT_ENABLE, TIMER_COMPARE, TIMER_COUNT, TIMER_PRESCALER, TIMER_CTC,
+    FG_START, FG_STOP) = range(1, 13)
+GPIO_NAMES = ["NONE/ERROR", "X_STEP", "Y_STEP", "Z_STEP", "X_DIR", "Y_DIR",
+    "Z_DIR", "X_LIMIT", "Y_LIMIT", "Z_LIMIT", "SERVO_OFF", "SPINDLE_ON",
+    "SPINDLE_CCW", "CHARGE_PUMP", "COOL_FLOOD", "COOL_MIST"]
+EVENT_NAMES = ["NONE/ERROR", "OVERFLOW", "COMPARE_A", "COMPARE_B"]
+TYPE_NAMES = {GPIO_WRITE: "GPIO write", GPIO_DIRECTION: "GPIO direction",
+    INTERRUPTS: "sei/cli", VECTOR_ENTER: "vector entry",
+    VECTOR_EXIT: "vector exit", INTERRUPT_ENABLE: "interrupt enable",
+    TIMER_COMPARE: "timer compare", TIMER_COUNT: "timer count",
+    TIMER_PRESCALER: "timer prescaler", TIMER_CTC: "timer mode",
+    FG_START: "WGM start", FG_STOP: "WGM stop"}
+
+def name(names, index):
+    return names[index] if index < len(names) else "#%d" % index
+
+def describe(kind, id, arg, value):
+    """Same wording as the host HAL's log"""
+    if kind == GPIO_WRITE:
+        return "GPIO: Output %s set %s" % (name(GPIO_NAMES, id),
+            "HIGH" if value else "LOW")
+    if kind == GPIO_DIRECTION:
+        return "GPIO: %s configured as %s" % (name(GPIO_NAMES, id),
+            "OUTPUT" if value else "INPUT")
+    if kind == INTERRUPTS:
+        return "INTR: Interrupts are now globally %s" % (
+            "enabled" if value else "disabled")
+    if kind == VECTOR_ENTER:
+        return "CTTM: %s condition on timer %d, executing interrupt vector" % (
+            name(EVENT_NAMES, arg), id)
+    if kind == VECTOR_EXIT:
+        return "CTTM: return from %s condition interrupt vector of timer %d" % (
+            name(EVENT_NAMES, arg), id)
+    if kind == INTERRUPT_ENABLE:
+        return "INTR: %s interrupt for timer %d event %s" % (
+            "Enabled" if value else "Disabled", id, name(EVENT_NAMES, arg))
+    if kind == TIMER_COMPARE:
+        return "CTTM: Set counter/timer %d %s value to %d" % (id,
+            name(EVENT_NAMES, arg), value)
+    if kind == TIMER_COUNT:
+        return "CTTM: Set counter/timer %d count value to %d" % (id, value)
+    if kind == TIMER_PRESCALER:
+        if not value:
+            return ("CTTM: Set counter/timer %d to no prescaler (i.e. stopped)"
+                % id)
+        return "CTTM: Set counter/timer %d divisor to %d" % (id, value)
+    if kind == TIMER_CTC:
+        return "CTTM: Set counter/timer %d operation mode to CTC" % id
+    if kind == FG_START:
+        return "GPIO: Output %s configured for WGM, square-wave, 50%%, %dHz" % (
+            name(GPIO_NAMES, id), value)
+    if kind == FG_STOP:
+        return "GPIO: Output %s WGM configuration disabled" % name(GPIO_NAMES,
+            id)
+    return "????: Unknown event type %d" % kind
+
+def records(trace):
+    """Yields (cycles, type, id, arg, value) for every record in trace"""
+    data = mmap.mmap(trace.fileno(), 0, access=mmap.ACCESS_READ)
+    if len(data) < HEADER.size:
+        sys.exit("%s: too short for a trace" % trace.name)
+    magic, version, size, fosc = HEADER.unpack_from(data)
+    if magic.rstrip("\0") != MAGIC or version != VERSION or size != RECORD.size:
+        sys.exit("%s: not a version %d grbl trace" % (trace.name, VERSION))
+    yield fosc
+    for offset in xrange(HEADER.size, len(data) - size + 1, size):
+        cycles, value, kind, id, arg = RECORD.unpack_from(data, offset)
+        yield cycles, kind, id, arg, value
+
+# Define command line argument interface
+parser = argparse.ArgumentParser(description="Decode a binary trace recorded "
+    "by a host build of grbl (grbl -t <file>).")
+parser.add_argument("trace_file", type=argparse.FileType("rb"),
+    help="trace file to decode")
+parser.add_argument("-s", "--summary", action="store_true", default=False,
+    help="only count events by type, and pulses by output")
+parser.add_argument("-c", "--cycles", action="store_true", default=False,
+    help="time stamp events in CPU cycles rather than seconds")
+args = parser.parse_args()
+
+events = records(args.trace_file)
+fosc = next(events)
+if args.summary:
+    counts, pulses, last = {}, {}, 0
+    for cycles, kind, id, arg, value in events:
+        counts[kind] = counts.get(kind, 0) + 1
+        if kind == GPIO_WRITE and value:
+            pulses[id] = pulses.get(id, 0) + 1
+        last = cycles
+    print "%.6fs of simulated time, %d events" % (float(last) / fosc,
+        sum(counts.values()))
+    for kind in sorted(counts):
+        print "%-20s %10d" % (TYPE_NAMES.get(kind, "#%d" % kind), counts[kind])
+    for id in sorted(pulses):
+        print "%-20s %10d times HIGH" % (name(GPIO_NAMES, id), pulses[id])
+else:
+    try:
+        for cycles, kind, id, arg, value in events:
+            if args.cycles: stamp = "%14d" % cycles
+            else: stamp = "%14.7f" % (float(cycles) / fosc)
+            print stamp, describe(kind, id, arg, value)
+    except IOError:
+        pass # Output piped into head or less and closed early
@@ -0,0 +1,222 @@
+#!/usr/bin/env python
+"""\
+Check a simulated step trace against grbl's motion limits
+
+Rebuilds per axis velocity and acceleration from the steps grbl took in a
+simulated run and flags every interval where the machine moved faster than
+the block's nominal feed, accelerated harder than the acceleration setting or
+went through a junction faster than the planner allowed.
+
+Steps come from either sim/grbl_sim (-s steps.csv, recorded with -p 0 so that
+every step is in there) or a host build's binary trace (grbl -t trace.bin).
+Feed and junction checks need the plan, i.e. the blocks CSV from grbl_sim -b.
+Without it the whole run is checked as one block, for acceleration only, and
+corners show up as violations.
+
+Velocities are averaged over windows of --window seconds, aligned to block
+starts. Counting whole steps in a window is off by up to one step per axis, so
+each figure comes with the error that allows for and is only flagged when it
+exceeds its limit by more than that (plus --tolerance). Longer windows give
+smaller errors but need longer blocks: those shorter than two windows only
+get their feed and junction checked.
+"""
+
+from bisect import bisect_right
+import argparse
+import csv
+import math
+import struct
+import sys
+
+
+AXES = "XYZ"
+# Make sure these are in sync with settings.h (DEFAULT_SETTINGS)
+STEPS_PER_MM = "200,200,200"
+ACCELERATION = 6.0 # mm/sec^2
+# Make sure these are in sync with host-i386-private.h and host-i386.h
+TRACE_HEADER = struct.Struct("<8sHHI")
+TRACE_RECORD = struct.Struct("<QIBBBx")
+TRACE_MAGIC = "GRBLTRC"
+TRACE_GPIO_WRITE = 0x01
+GPIO_STEP = (0x01, 0x02, 0x03)
+GPIO_DIR = (0x04, 0x05, 0x06)
+
+def read_trace(f, invert):
+    """Yields (time, axis, +1/-1) for every step pulse in a binary trace"""
+    data = f.read()
+    magic, version, size, fosc = TRACE_HEADER.unpack_from(data)
+    if magic.rstrip("\0") != TRACE_MAGIC or size != TRACE_RECORD.size:
+        sys.exit("%s: not a grbl trace" % f.name)
+    level = [0] * 7
+    for offset in xrange(TRACE_HEADER.size, len(data) - size + 1, size):
+        cycles, value, kind, id, arg = TRACE_RECORD.unpack_from(data, offset)
+        if kind != TRACE_GPIO_WRITE or id > 6: continue
+        value = 1 if value else 0
+        if invert & (1 << (id - 1)): value ^= 1
+        rising = value and not level[id]
+        level[id] = value
+        if rising and id in GPIO_STEP:
+            axis = GPIO_STEP.index(id)
+            yield (float(cycles) / fosc, axis,
+                -1 if level[GPIO_DIR[axis]] else 1)
+
+def read_steps_csv(f):
+    """Yields (time, axis, +1/-1) from grbl_sim's stepper position rows"""
+    rows = csv.reader(f)
+    next(rows) # Header
+    last, coarse = None, False
+    for row in rows:
+        t, position = float(row[0]), [int(v) for v in row[2:5]]
+        if last is not None:
+            for axis in range(3):
+                delta = position[axis] - last[axis]
+                coarse = coarse or abs(delta) > 1
+                for i in range(abs(delta)):
+                    yield t, axis, 1 if delta > 0 else -1
+        last = position
+    if coarse:
+        print >>sys.stderr, ("Warning: %s holds more than one step per row, "
+            "record it with grbl_sim -p 0 for accurate results" % f.name)
+
+def read_blocks(f):
+    """Returns a list of (start time, block dict) from grbl_sim -b"""
+    return [(float(row["time"]), row) for row in csv.DictReader(f)]
+
+class Axis:
+    """Position of one axis over time, in steps"""
+
+    def __init__(self):
+        self.times, self.positions = [], []
+
+    def step(self, t, direction):
+        self.times.append(t)
+        self.positions.append(
+            (self.positions[-1] if self.positions else 0) + direction)
+
+    def at(self, t):
+        """Position right after any steps at time t"""
+        i = bisect_right(self.times, t)
+        return self.positions[i - 1] if i else 0
+
+class Checker:
+    def __init__(self, args, axes):
+        self.args, self.axes, self.violations = args, axes, 0
+        self.worst = {"feed": 0.0, "acceleration": 0.0, "junction": 0.0}
+        # Velocity error from miscounting one step at either end of a window,
+        # per axis and along the path, and the acceleration error that makes
+        self.dv = [1.0 / (spm * args.window) for spm in args.steps_per_mm]
+        self.dv_path = math.sqrt(sum(dv * dv for dv in self.dv))
+        self.da = [2 * dv / args.window for dv in self.dv]
+        self.da_path = 2 * self.dv_path / args.window
+
+    def velocity(self, start, length):
+        """Per axis mean velocity (mm/sec) from start over length seconds"""
+        return [(axis.at(start + length) - axis.at(start)) / spm / length
+            for axis, spm in zip(self.axes, self.args.steps_per_mm)]
+
+    def flag(self, kind, t, block, what, value, limit, error):
+        excess = value - limit - error
+        if excess <= limit * self.args.tolerance: return
+        self.violations += 1
+        self.worst[kind] = max(self.worst[kind], excess / limit if limit else
+            float("inf"))
+        if self.violations <= self.args.max_reports:
+            print "%12.6fs block %5s: %s %.3f > %.3f (+%.3f quantization)" % (
+                t, block, what, value, limit, error)
+
+    def check_block(self, start, end, block):
+        args, index = self.args, block["block"] if block else "-"
+        windows = int((end - start) / args.window)
+        velocities = [self.velocity(start + i * args.window, args.window)
+            for i in range(windows)]
+        if block and end > start:
+            # The plan is in mm/min
+            nominal = float(block["nominal_speed"]) / 60
+            for i, v in enumerate(velocities):
+                self.flag("feed", start + i * args.window, index,
+                    "feed (mm/sec)", norm(v), nominal, self.dv_path)
+            # Mean speed over the first window (or the whole block, if shorter)
+            # can't be higher than the junction limit plus what accelerating
+            # allows for in that time
+            span = min(args.window, end - start)
+            junction = (float(block["max_entry_speed"]) / 60 +
+                args.acceleration * span)
+            self.flag("junction", start, index, "junction speed (mm/sec)",
+                norm(self.velocity(start, span)), junction,
+                self.dv_path * args.window / span)
+        for i in range(1, windows):
+            t = start + i * args.window
+            a = [(v1 - v0) / args.window for v0, v1 in
+                zip(velocities[i - 1], velocities[i])]
+            for axis in range(3):
+                self.flag("acceleration", t, index, "%s acceleration "
+                    "(mm/sec^2)" % AXES[axis], abs(a[axis]), args.acceleration,
+                    self.da[axis])
+            self.flag("acceleration", t, index, "path acceleration (mm/sec^2)",
+                norm(a), args.acceleration, self.da_path)
+
+def norm(v):
+    return math.sqrt(sum(x * x for x in v))
+
+def floats(text):
+    values = [float(x) for x in text.split(",")]
+    if len(values) == 1: values *= 3
+    if len(values) != 3: raise argparse.ArgumentTypeError("need 1 or 3 values")
+    return values
+
+# Define command line argument interface
+parser = argparse.ArgumentParser(description="Check a simulated step trace "
+    "against grbl's feed, acceleration and junction limits. Exits with 1 if "
+    "any were exceeded.")
+parser.add_argument("steps_file", type=argparse.FileType("rb"),
+    help="grbl_sim -s steps CSV (recorded with -p 0) or grbl -t binary trace")
+parser.add_argument("-b", "--blocks", type=argparse.FileType("r"),
+    help="grbl_sim -b blocks CSV of the same run, for feed and junction "
+    "checks")
+parser.add_argument("-s", "--steps-per-mm", type=floats,
+    default=floats(STEPS_PER_MM), help="settings $0-$2, one value or x,y,z "
+    "(default %s)" % STEPS_PER_MM)
+parser.add_argument("-a", "--acceleration", type=float, default=ACCELERATION,
+    help="settings $8, in mm/sec^2 (default %g)" % ACCELERATION)
+parser.add_argument("-w", "--window", type=float, default=0.1,
+    help="seconds to average velocity over (default 0.1)")
+parser.add_argument("-t", "--tolerance", type=float, default=0.0,
+    help="relative excess allowed on top of quantization (e.g. 0.01)")
+parser.add_argument("-i", "--invert-mask", type=int, default=0,
+    help="settings $6, for binary traces of machines with inverted pins")
+parser.add_argument("-m", "--max-reports", type=int, default=50,
+    help="stop listing violations after this many (default 50)")
+args = parser.parse_args()
+
+axes = [Axis(), Axis(), Axis()]
+if args.steps_file.read(len(TRACE_MAGIC)) == TRACE_MAGIC:
+    args.steps_file.seek(0)
+    steps = read_trace(args.steps_file, args.invert_mask)
+else:
+    args.steps_file.seek(0)
+    steps = read_steps_csv(args.steps_file)
+end = 0.0
+for t, axis, direction in steps:
+    axes[axis].step(t, direction)
+    end = max(end, t)
+
+checker = Checker(args, axes)
+if args.blocks:
+    blocks = read_blocks(args.blocks)
+    for i, (start, block) in enumerate(blocks):
+        stop = blocks[i + 1][0] if i + 1 < len(blocks) else end
+        checker.check_block(start, stop, block)
+else:
+    checker.check_block(0.0, end, None)
+
+print "%d steps over %.3fs, %s blocks, %gs windows: +/-%.3f mm/sec, " \
+    "+/-%.3f mm/sec^2 quantization along the path" % (
+    sum(len(axis.times) for axis in axes), end,
+    len(blocks) if args.blocks else "no", args.window, checker.dv_path,
+    checker.da_path)
+if checker.violations:
+    print "%d violations, worst excess: %s" % (checker.violations, ", ".join(
+        "%s %.1f%%" % (kind, 100 * excess) for kind, excess in
+        sorted(checker.worst.items()) if excess))
+    sys.exit(1)
+print "All within limits"
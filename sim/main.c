@@ -19,61 +19,235 @@
   along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <inttypes.h>
+/* Runs a g-code program from stdin through grbl on the hosting HAL, in
+ * simulated time, and writes what the planner and the steppers made of it as
+ * CSV: one row per block as the stepper starts executing it, and rows of
+ * time stamped stepper positions (from sys.position). A summary of the run,
+ * total time and steps, can go to a third one. Grbl's own responses go to
+ * stdout as usual. The program comes in at CONSOLE_BAUD_RATE, as if streamed
+ * by a host keeping grbl's Rx buffer full, so the planner gets to look as far
+ * ahead as it would on the machine.
+ *
+ * Usage: grbl_sim [-b blocks.csv] [-s steps.csv] [-p period] [-r summary.csv]
+ *          < program.nc
+ *
+ * Given program files instead, it runs them all in batch, one simulation per
+ * file in a pool of -j worker processes (grbl being all static globals), by
+ * default one per core, and prints each one's summary as a CSV row as it
+ * completes. A file fails if grbl answered any of its lines with an error,
+ * as in regress/:
+ *
+ *        grbl_sim [-j jobs] program.nc ... */
+
 #include <stdio.h>
 #include <stdlib.h>
-#include "../planner.h"
-#include "../stepper.h"
-#include "../gcode.h"
-#include "../protocol.h"
-#include "../nuts_bolts.h"
-#include "../settings.h"
-#include "../spindle_control.h"
-#include "../limits.h"
-#include "../runtime.h"
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "config.h"
+
+#include "coolant_control.h"
+#include "gcode.h"
+#include "limits.h"
+#include "motion_control.h"
+#include "nuts_bolts.h"
+#include "planner.h"
+#include "protocol.h"
+#include "settings.h"
+#include "spindle_control.h"
+#include "stepper.h"
 #include "simulator.h"
 
 
-int main(int argc, char *argv[]) {
-  // Get the minimum time step for printing stepper values.
-  // If not given or the command line cannot be parsed to a float than
-  // step_time= 0.0; This means to not print stepper values at all
-  if(argc>1) {
-	  argv++;
-	  step_time= atof(*argv);
+// Declare system global variable structure
+system_t sys;
+
+// A batch simulation in progress
+typedef struct {
+  pid_t pid;
+  int summary; // Read end of the pipe its summary comes through
+  FILE *responses; // Grbl's console output
+  const char *name;
+} job_t;
+
+
+static FILE *open_output(const char *name) {
+  FILE *f = fopen(name, "w");
+
+  if(!f) {
+    perror(name);
+    exit(EXIT_FAILURE);
   }
 
-  // Setup output file handles. Block info goes to stdout. Stepper values go to stderr.
-  block_out_file= stdout;
-  step_out_file= stderr;
-  // Make sure the output streams are flushed immediately.
-  // This is important when using the simulator inside another application in parallel
-  // to the real grbl.
-  // Theoretically flushing could be limited to complete lines. Unfortunately Windows
-  // does not know line buffered streams. So for now we stick to flushing every character.
-  setvbuf(stdout, NULL, _IONBF, 1);
-  setvbuf(stderr, NULL, _IONBF, 1);
-  
+  return f;
+}
+
+// Runs the program on stdin to its end, never returns
+static void simulate(char *name) {
+  i386_set_log_level(0); // Console only, the CSV files are what this is about
+  i386_set_private_nvs(); // Settings are reset anyway, and runs may go in parallel
+  optind = 1; // The HAL gets no options of its own but parses them anyway
+  host_init(1, &name);
+  host_serialconsole_init();
   st_init(); // Setup stepper pins and interrupt timers
-  memset(&sys, 0, sizeof(sys));  // Clear all system variables
+  host_sei(); // Enable interrupts
+
+  // Same as a reset in grbl's main(), but always with default settings so that runs compare
+  memset(&sys, 0, sizeof(sys));
   settings_reset();
   protocol_init(); // Clear incoming line data
   plan_init(); // Clear block buffer and planner variables
+  mc_init(); // Clear motion queue
   gc_init(); // Set g-code parser to default state
   spindle_init();
+  coolant_init();
   limits_init();
   st_reset(); // Clear stepper subsystem variables.
-  sys.auto_start = true; // runtime commands are not processed. We start to simulate immediately
-  
-  // Main loop of command processing until EOF is encountered
-  protocol_process();
-  
-  // flush the block buffer and print stepper info on any pending blocks
-  plan_synchronize();
-
-  // Graceful exit
-  fclose(block_out_file);
-  fclose(step_out_file);
-  
+  sys.auto_start = true; // Runtime commands are not processed. We start to simulate immediately
+
+  sim_init();
+  // The HAL exits once it runs out of input and everything has been executed
+  atexit(sim_finish);
+
+  // Main loop of command processing until the program ends
+  while(!sys.abort) protocol_process();
+
   exit(EXIT_SUCCESS);
 }
+
+// Starts simulating one program in a child process, its summary comes through job->summary
+static bool start_job(job_t *job) {
+  int fds[2];
+
+  if(!(job->responses = tmpfile())) {
+    perror("tmpfile");
+    return false;
+  }
+  if(pipe(fds)) {
+    perror("pipe");
+    fclose(job->responses);
+    return false;
+  }
+  fflush(stdout); // Or the child prints it again
+  if((job->pid = fork()) == 0) {
+    close(fds[0]);
+    if(!freopen(job->name, "r", stdin)) {
+      perror(job->name);
+      _exit(EXIT_FAILURE);
+    }
+    dup2(fileno(job->responses), STDOUT_FILENO);
+    summary_out_file = fdopen(fds[1], "w");
+    simulate((char *)job->name);
+  }
+  close(fds[1]);
+  if(job->pid < 0) {
+    perror("fork");
+    close(fds[0]);
+    fclose(job->responses);
+    return false;
+  }
+  job->summary = fds[0];
+
+  return true;
+}
+
+// Counts the lines grbl answered with an error, like regress/run.sh does
+static uint32_t count_errors(FILE *responses) {
+  char line[256];
+  uint32_t errors = 0;
+
+  rewind(responses);
+  while(fgets(line, sizeof(line), responses))
+    if(!strncmp(line, "error", 5)) errors++;
+  fclose(responses);
+
+  return errors;
+}
+
+// Prints the summary of a finished job, minus the header, prefixed with the file name
+static bool finish_job(job_t *job, int status) {
+  char buffer[256], *row;
+  ssize_t length = 0, got;
+  uint32_t errors = count_errors(job->responses);
+
+  while(length < sizeof(buffer) - 1 &&
+      (got = read(job->summary, buffer + length, sizeof(buffer) - 1 - length)) > 0)
+    length += got;
+  close(job->summary);
+  buffer[length] = '\0';
+  row = strchr(buffer, '\n');
+  if(!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS || !row || !row[1]) {
+    fprintf(stderr, "%s: simulation failed\n", job->name);
+    return false;
+  }
+  if(errors) {
+    fprintf(stderr, "%s: %lu lines in error\n", job->name, (unsigned long)errors);
+    return false;
+  }
+  printf("%s,%s", job->name, row + 1);
+
+  return true;
+}
+
+static int batch(char **names, int count, int jobs) {
+  job_t *pool = calloc(jobs, sizeof(job_t));
+  int next = 0, running = 0, failed = 0, status, i;
+  pid_t pid;
+
+  printf("file,time,blocks,x,y,z,steps_x,steps_y,steps_z\n");
+  while(next < count || running) {
+    for(i = 0; i < jobs && next < count; i++)
+      if(!pool[i].pid) {
+        pool[i].name = names[next++];
+        if(start_job(&pool[i])) running++;
+        else {
+          pool[i].pid = 0;
+          failed++;
+        }
+      }
+    if(!running) break;
+    if((pid = wait(&status)) < 0) {
+      perror("wait");
+      exit(EXIT_FAILURE);
+    }
+    for(i = 0; i < jobs; i++)
+      if(pool[i].pid == pid) {
+        if(!finish_job(&pool[i], status)) failed++;
+        pool[i].pid = 0;
+        running--;
+      }
+  }
+  free(pool);
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+  int option, jobs = sysconf(_SC_NPROCESSORS_ONLN);
+
+  while((option = getopt(argc, argv, "b:s:p:r:j:")) != -1)
+    switch(option) {
+      case 'b': block_out_file = open_output(optarg); break;
+      case 's': step_out_file = open_output(optarg); break;
+      case 'r': summary_out_file = open_output(optarg); break;
+      // Minimum time step for printing stepper values, zero prints them all
+      case 'p': step_time = atof(optarg); break;
+      case 'j': jobs = atoi(optarg); break;
+      default:
+        fprintf(stderr, "Usage: %s [-b blocks.csv] [-s steps.csv] [-p period] [-r summary.csv] < program.nc\n"
+            "       %s [-j jobs] program.nc ...\n", argv[0], argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+  if(optind < argc) {
+    if(block_out_file || step_out_file || summary_out_file) {
+      fprintf(stderr, "%s: -b, -s and -r take a single program on stdin\n", argv[0]);
+      exit(EXIT_FAILURE);
+    }
+    return batch(argv + optind, argc - optind, jobs > 0 ? jobs : 1);
+  }
+  simulate(argv[0]);
+
+  return EXIT_SUCCESS; /* never reached */
+}
@@ -0,0 +1,348 @@
+/*
+  simavr.c - runs the production AVR build under simavr and measures it
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Loads main.elf into a simavr ATmega328p, streams the g-code program on stdin
+ * into USART0 the way script/stream.py does (counting characters against
+ * grbl's Rx buffer) and watches the STEP/DIR pins (PORTC, see config-avr.h)
+ * while it executes. Once every line has been acknowledged and a '?' status
+ * report says grbl is idle, it prints:
+ *  - per interrupt vector: count, min/avg/max cycles from entry to RETI (an
+ *    interrupt that lets others nest counts their time too) and how often it
+ *    was re-entered before returning, which is left out of the other figures;
+ *  - the highest step rate the stepper interrupt could sustain at its worst
+ *    and average cost, next to the highest rate actually seen on the pins;
+ *  - serial throughput: bytes and lines per second from the first byte sent
+ *    to the last acknowledgement.
+ * Grbl's responses (except the status polls) go to stdout. Everything is in
+ * simulated time, cycle accurate as far as simavr's core is.
+ *
+ * Usage: grbl_simavr [-m mcu] [-f frequency] [-w pins.vcd] [-t limit]
+ *          main.elf < program.nc */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <avr_ioport.h>
+#include <avr_uart.h>
+#include <sim_avr.h>
+#include <sim_elf.h>
+#include <sim_interrupts.h>
+#include <sim_irq.h>
+#include <sim_vcd_file.h>
+
+#ifndef DEVICE
+# define DEVICE "atmega328p"
+#endif
+#ifndef F_CPU
+# define F_CPU 16000000
+#endif
+
+// Make sure these are in sync with config-avr.h
+#define PINS_PORT 'C'
+#define PIN_STEP_X 0
+#define PIN_DIR_X 3
+#define AXES 3
+
+#define RX_BUFFER_SIZE 128 // Only used if grbl's startup banner doesn't tell
+#define LINE_SIZE 256
+#define MAX_IN_FLIGHT 256 // Unacknowledged lines tracked
+#define VECTORS 26 // ATmega328p, including reset
+#define STEPPER_VECTOR 11 // TIMER1_COMPA_vect
+#define POLL_PERIOD 0.1 // Seconds between status polls once all is sent
+
+static const char *vector_names[VECTORS] = {
+  "RESET", "INT0", "INT1", "PCINT0", "PCINT1", "PCINT2", "WDT", "TIMER2_COMPA",
+  "TIMER2_COMPB", "TIMER2_OVF", "TIMER1_CAPT", "TIMER1_COMPA", "TIMER1_COMPB",
+  "TIMER1_OVF", "TIMER0_COMPA", "TIMER0_COMPB", "TIMER0_OVF", "SPI_STC",
+  "USART_RX", "USART_UDRE", "USART_TX", "ADC", "EE_READY", "ANALOG_COMP",
+  "TWI", "SPM_READY"
+};
+
+typedef struct {
+  avr_cycle_count_t entered, min, max, total;
+  uint8_t depth; // Entries without a RETI yet, more than one after a re-entry
+  uint32_t count, nested;
+} isr_stats_t;
+
+static avr_t *avr;
+static isr_stats_t isr_stats[VECTORS];
+
+// Step pins
+static uint8_t pin_level[2 * AXES];
+static int32_t position[AXES];
+static uint32_t steps;
+static avr_cycle_count_t last_step, min_step_interval = UINT64_MAX;
+
+// Serial streaming
+static avr_irq_t *uart_input;
+static bool xon = true;
+static char line[LINE_SIZE]; // Next line to send
+static size_t line_length, line_sent;
+static bool banner, input_done, idle;
+static uint32_t rx_size = RX_BUFFER_SIZE;
+static uint32_t in_flight[MAX_IN_FLIGHT]; // Lengths of unacknowledged lines, a ring
+static uint32_t in_flight_head, in_flight_count, in_flight_bytes;
+static char response[LINE_SIZE];
+static size_t response_length;
+static uint32_t bytes_sent, lines_acked, errors;
+static avr_cycle_count_t first_byte, last_ack, last_poll;
+static bool polling;
+
+
+static void isr_hook(struct avr_irq_t *irq, uint32_t value, void *param) {
+  isr_stats_t *stats = param;
+  avr_cycle_count_t cycles;
+
+  // TIMER1_COMPA re-enables interrupts halfway through and may be entered
+  // again before it returns. Count the depth so the inner RETI doesn't end
+  // the outer invocation, whose time already includes the nested one.
+  if(value) {
+    if(stats->depth++) stats->nested++;
+    else stats->entered = avr->cycle;
+    return;
+  }
+  if(!stats->depth) return; // Entered before the hook was registered
+  if(--stats->depth) return;
+  cycles = avr->cycle - stats->entered;
+  if(!stats->count || cycles < stats->min) stats->min = cycles;
+  if(cycles > stats->max) stats->max = cycles;
+  stats->total += cycles;
+  stats->count++;
+}
+
+static void pin_hook(struct avr_irq_t *irq, uint32_t value, void *param) {
+  uint8_t pin = (uintptr_t)param;
+
+  value = value ? 1 : 0;
+  // Grbl's default invert mask ($6) is 0, a step starts on the rising edge
+  if(pin < PIN_DIR_X && value && !pin_level[pin]) {
+    position[pin] += pin_level[PIN_DIR_X + pin] ? -1 : 1;
+    if(steps && avr->cycle != last_step && avr->cycle - last_step < min_step_interval)
+      min_step_interval = avr->cycle - last_step;
+    last_step = avr->cycle; // Axes stepping together are one step event
+    steps++;
+  }
+  pin_level[pin] = value;
+}
+
+static void xon_hook(struct avr_irq_t *irq, uint32_t value, void *param) {
+  xon = true;
+}
+
+static void xoff_hook(struct avr_irq_t *irq, uint32_t value, void *param) {
+  xon = false;
+}
+
+static void handle_response(void) {
+  unsigned int size;
+
+  if(!strncmp(response, "Grbl ", 5)) {
+    banner = true;
+    if(sscanf(response, "Grbl %*s [RX:%u", &size) == 1) rx_size = size;
+  }
+  if(!strncmp(response, "ok", 2) || !strncmp(response, "error", 5)) {
+    if(in_flight_count) {
+      in_flight_bytes -= in_flight[in_flight_head];
+      in_flight_head = (in_flight_head + 1) % MAX_IN_FLIGHT;
+      in_flight_count--;
+    }
+    if(response[0] == 'e') errors++;
+    lines_acked++;
+    last_ack = avr->cycle;
+  }
+  if(response[0] == '<' && polling) {
+    polling = false;
+    idle = input_done && !in_flight_count && !strncmp(response, "<Idle", 5);
+    return;
+  }
+  puts(response);
+}
+
+static void uart_output_hook(struct avr_irq_t *irq, uint32_t value, void *param) {
+  if(value == '\r') return;
+  if(value != '\n') {
+    if(response_length < LINE_SIZE - 1) response[response_length++] = value;
+    return;
+  }
+  response[response_length] = '\0';
+  response_length = 0;
+  if(response[0]) handle_response();
+}
+
+static void send_byte(uint8_t c) {
+  if(!bytes_sent++) first_byte = avr->cycle;
+  avr_raise_irq(uart_input, c);
+}
+
+// Sends as much of the program as grbl's Rx buffer and simavr's UART take
+static void feed(void) {
+  int c;
+
+  if(!xon || !banner) return; // Nothing gets through before the Rx interrupt is on
+  if(line_sent == line_length && !input_done) {
+    line_length = line_sent = 0;
+    while((c = getchar()) != EOF && c != '\n')
+      if(c != '\r' && line_length < LINE_SIZE - 2) line[line_length++] = c;
+    if(c == EOF && !line_length) {
+      input_done = true;
+      return;
+    }
+    line[line_length++] = '\n';
+  }
+  if(line_sent < line_length) {
+    if(!line_sent) {
+      // Whole lines only, like stream.py
+      if(in_flight_count == MAX_IN_FLIGHT || in_flight_bytes + line_length > rx_size - 1) return;
+      in_flight[(in_flight_head + in_flight_count++) % MAX_IN_FLIGHT] = line_length;
+      in_flight_bytes += line_length;
+    }
+    send_byte(line[line_sent++]);
+    return;
+  }
+  // All sent, poll for the end of motion
+  if(input_done && !in_flight_count && !polling &&
+      avr->cycle - last_poll > POLL_PERIOD * avr->frequency) {
+    polling = true;
+    last_poll = avr->cycle;
+    send_byte('?');
+    bytes_sent--; // Not part of the program
+  }
+}
+
+static void report(void) {
+  double seconds, streaming;
+  isr_stats_t *stepper = &isr_stats[STEPPER_VECTOR];
+  int i;
+
+  seconds = (double)avr->cycle / avr->frequency;
+  printf("\n%s at %.0f MHz, %.6f s simulated\n", avr->mmcu, avr->frequency / 1e6, seconds);
+  printf("%-14s %10s %8s %10s %8s %7s %8s\n", "vector", "count", "min", "avg", "max", "load",
+      "nested");
+  for(i = 0; i < VECTORS; i++)
+    if(isr_stats[i].count)
+      printf("%-14s %10lu %8llu %10.1f %8llu %6.2f%% %8lu\n", vector_names[i],
+          (unsigned long)isr_stats[i].count, (unsigned long long)isr_stats[i].min,
+          (double)isr_stats[i].total / isr_stats[i].count,
+          (unsigned long long)isr_stats[i].max,
+          100.0 * isr_stats[i].total / avr->cycle, (unsigned long)isr_stats[i].nested);
+  if(stepper->count)
+    printf("step rate: %.0f Hz sustainable at worst stepper interrupt cost, "
+        "%.0f Hz at average, %.0f Hz peak seen on the pins\n",
+        (double)avr->frequency / stepper->max,
+        (double)avr->frequency * stepper->count / stepper->total,
+        min_step_interval != UINT64_MAX ? (double)avr->frequency / min_step_interval : 0.0);
+  printf("steps: %lu, final position %ld,%ld,%ld\n", (unsigned long)steps,
+      (long)position[0], (long)position[1], (long)position[2]);
+  streaming = (double)(last_ack - first_byte) / avr->frequency;
+  if(streaming > 0)
+    printf("serial: %lu bytes, %lu lines (%lu errors) in %.3f s: %.0f bytes/s, %.1f lines/s\n",
+        (unsigned long)bytes_sent, (unsigned long)lines_acked, (unsigned long)errors,
+        streaming, bytes_sent / streaming, lines_acked / streaming);
+}
+
+int main(int argc, char *argv[]) {
+  elf_firmware_t firmware;
+  avr_vcd_t vcd;
+  const char *mcu = DEVICE, *vcd_file = NULL;
+  uint32_t frequency = F_CPU, flags = 0;
+  double limit = 3600;
+  int option, state = cpu_Running;
+  uint8_t i;
+  avr_irq_t *irq;
+
+  while((option = getopt(argc, argv, "m:f:w:t:")) != -1)
+    switch(option) {
+      case 'm': mcu = optarg; break;
+      case 'f': frequency = atol(optarg); break;
+      case 'w': vcd_file = optarg; break;
+      // Simulated seconds before giving up on a program that never ends
+      case 't': limit = atof(optarg); break;
+      default:
+        fprintf(stderr, "Usage: %s [-m mcu] [-f frequency] [-w pins.vcd] [-t limit] main.elf < program.nc\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+  if(optind != argc - 1) {
+    fprintf(stderr, "%s: no firmware given\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  memset(&firmware, 0, sizeof(firmware));
+  if(elf_read_firmware(argv[optind], &firmware)) {
+    fprintf(stderr, "%s: cannot load %s\n", argv[0], argv[optind]);
+    exit(EXIT_FAILURE);
+  }
+  // Grbl doesn't carry an .mmcu section, the Makefile knows what it built for
+  if(!firmware.mmcu[0]) strncpy(firmware.mmcu, mcu, sizeof(firmware.mmcu) - 1);
+  if(!firmware.frequency) firmware.frequency = frequency;
+  if(!(avr = avr_make_mcu_by_name(firmware.mmcu))) {
+    fprintf(stderr, "%s: simavr doesn't know %s\n", argv[0], firmware.mmcu);
+    exit(EXIT_FAILURE);
+  }
+  avr_init(avr);
+  avr_load_firmware(avr, &firmware);
+
+  // Talk to USART0 ourselves instead of simavr echoing it to the console, and don't have simavr
+  // sleep in real time whenever the firmware looks at an empty receiver
+  avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+  flags &= ~(AVR_UART_FLAG_STDIO | AVR_UART_FLAG_POOL_SLEEP);
+  avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+  uart_input = avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_INPUT);
+  avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT),
+      uart_output_hook, NULL);
+  avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUT_XON),
+      xon_hook, NULL);
+  avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUT_XOFF),
+      xoff_hook, NULL);
+
+  if(vcd_file) avr_vcd_init(avr, vcd_file, &vcd, 100000 /* us between flushes */);
+  for(i = 0; i < 2 * AXES; i++) {
+    static const char *names[2 * AXES] = {"STEP_X", "STEP_Y", "STEP_Z", "DIR_X", "DIR_Y", "DIR_Z"};
+
+    irq = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(PINS_PORT), PIN_STEP_X + i);
+    avr_irq_register_notify(irq, pin_hook, (void *)(uintptr_t)i);
+    if(vcd_file) avr_vcd_add_signal(&vcd, irq, 1, names[i]);
+  }
+  if(vcd_file) avr_vcd_start(&vcd);
+
+  // Entry (1) and RETI (0) of every vector
+  for(i = 1; i < VECTORS; i++)
+    if((irq = avr_get_interrupt_irq(avr, i)))
+      avr_irq_register_notify(irq + AVR_INT_IRQ_RUNNING, isr_hook, &isr_stats[i]);
+
+  while(!idle && state != cpu_Done && state != cpu_Crashed) {
+    feed();
+    state = avr_run(avr);
+    if(avr->cycle > limit * avr->frequency) {
+      fprintf(stderr, "%s: still running after %g s, giving up\n", argv[0], limit);
+      break;
+    }
+  }
+
+  if(vcd_file) avr_vcd_stop(&vcd);
+  report();
+  if(state == cpu_Crashed) {
+    fprintf(stderr, "%s: firmware crashed at PC 0x%04x\n", argv[0], (unsigned int)avr->pc);
+    exit(EXIT_FAILURE);
+  }
+
+  return idle && !errors ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,6 +1,6 @@
 /*
-  simulator.c - functions to simulate how the buffer is emptied and the
-    stepper interrupt is called
+  simulator.c - records the plan and the stepper trajectory as grbl executes
+    them on the hosting HAL
 
   Part of Grbl Simulator
 
@@ -20,108 +20,119 @@
   along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <stdio.h>
-#include <avr/interrupt.h>
 #include <inttypes.h>
-#include "../stepper.h"
-#include "../planner.h"
-#include "../nuts_bolts.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-// This variable is needed to determine if execute_runtime() is called in a loop
-// waiting for the buffer to empty, as in plan_synchronize()
-// it is reset in serial_write() because this is certainly called at the end of
-// every command processing
-int runtime_second_call= 0;
+#include "config.h"
 
+#include "simulator.h"
 
-// Current time of the stepper simulation
-double sim_time= 0.0;
-// Next time the status of stepper values should be printed
-double next_print_time= 0.0;
-// Minimum time step for printing stepper values. Given by user via command line
-double step_time= 0.0;
+#include "nuts_bolts.h"
+#include "planner.h"
 
-// global system variable structure for position etc.
-system_t sys;
 
 // Output file handles set by main program
 FILE *block_out_file;
 FILE *step_out_file;
+FILE *summary_out_file;
 
-// dummy port variables
-uint8_t stepping_ddr;
-uint8_t stepping_port;
-uint8_t spindle_ddr;
-uint8_t spindle_port;
+// Minimum time step for printing stepper values. Given by user via command line
+double step_time = 0.0;
 
+// Next time the stepper position should be printed
+static double next_print_time = 0.0;
+// Block being executed, its index and how many have been executed so far
+static block_t *last_block;
+static uint32_t block_index, block_count;
+static int32_t last_position[3];
+// Steps taken along each axis, either way
+static uint32_t step_count[3];
+static int32_t counted_position[3];
 
-// Stub of the timer interrupt function from stepper.c
-void interrupt_TIMER1_COMPA_vect();
 
-// Call the stepper interrupt until one block is finished
-void sim_stepper() {
-  block_t *current_block= plan_get_current_block();
+static double sim_time() {
+  return (double)i386_virtual_cycles() / HOST_TIMER_FOSC;
+}
 
-  // If the block buffer is empty, call the stepper interrupt one last time
-  // to let it handle sys.cycle_start etc.
-  if(current_block==NULL) {
-	  interrupt_TIMER1_COMPA_vect();
-	  return;
-  }
+static void print_position() {
+  fprintf(step_out_file, "%.9f,%" PRIu32 ",%" PRId32 ",%" PRId32 ",%" PRId32 "\n",
+      sim_time(), block_index, sys.position[X_AXIS], sys.position[Y_AXIS], sys.position[Z_AXIS]);
+  memcpy(last_position, sys.position, sizeof(last_position));
+}
 
-  while(current_block==plan_get_current_block()) {
-    interrupt_TIMER1_COMPA_vect();
+// Print the plan of a block as the stepper starts executing it, by then the planner is done
+// optimizing it.
+static void print_block(block_t *b) {
+  fprintf(block_out_file, "%.9f,%" PRIu32 ",%s%" PRIu32 ",%s%" PRIu32 ",%s%" PRIu32 ",%" PRId32
+      ",%f,%f,%f,%f,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRId32 ",%" PRIu32 ",%" PRIu32 "\n",
+      sim_time(), block_index,
+      b->dir_bits.flags.dir_x ? "-" : "", b->steps_x,
+      b->dir_bits.flags.dir_y ? "-" : "", b->steps_y,
+      b->dir_bits.flags.dir_z ? "-" : "", b->steps_z,
+      b->step_event_count, b->millimeters, b->nominal_speed, b->entry_speed, b->max_entry_speed,
+      b->initial_rate, b->nominal_rate, b->final_rate, b->rate_delta,
+      b->accelerate_until, b->decelerate_after);
+}
+
+// Called after every timer interrupt. Only the stepper's (timer 1 compare A) moves anything.
+static void sim_interrupt(uint8_t timer, uint8_t which) {
+  block_t *current_block;
+  uint8_t i;
+
+  if(timer != 1 || which != HOST_TIMER_INTERRUPT_COMPARE_A_flag) return;
 
-    // Check to see if we should print some info
-    if(step_time>0.0) {
-    	if(sim_time>=next_print_time) {
-          fprintf(step_out_file, "  step: %20.15f, %d, %d, %d\n", sim_time, sys.position[X_AXIS], sys.position[Y_AXIS], sys.position[Z_AXIS]);
+  for(i = 0; i < 3; i++) {
+    step_count[i] += labs(sys.position[i] - counted_position[i]);
+    counted_position[i] = sys.position[i];
+  }
 
-          // Make sure the simulation time doesn't get ahead of next_print_time
-          while(next_print_time<sim_time) next_print_time+= step_time;
-    	}
+  current_block = plan_get_current_block();
+  if(current_block != last_block) {
+    // Always record where the previous block ended
+    if(step_out_file && last_block) print_position();
+    if(current_block) {
+      block_index = block_count++;
+      if(block_out_file) print_block(current_block);
     }
+    last_block = current_block;
+  }
 
-    sim_time+= get_step_time();
+  if(step_out_file && memcmp(last_position, sys.position, sizeof(last_position)) &&
+      sim_time() >= next_print_time) {
+    print_position();
+    // Make sure the simulation time doesn't get ahead of next_print_time
+    if(step_time > 0.0)
+      while(next_print_time <= sim_time()) next_print_time += step_time;
   }
-  // always print stepper values at the end of a block
-  fprintf(step_out_file, "  step: %20.15f, %d, %d, %d, block_end\n", sim_time, sys.position[X_AXIS], sys.position[Y_AXIS], sys.position[Z_AXIS]);
 }
 
-// Print information about the most recently inserted block
-// but only once!
-void printBlock() {
-  block_t *b;
-  static block_t *last_block;
-
-  b= plan_get_recent_block();
-  if(b!=last_block && b!=NULL) {
-    fprintf(block_out_file,"  block: ");
-    if(b->direction_bits & (1<<X_DIRECTION_BIT)) fprintf(block_out_file,"-");
-    fprintf(block_out_file,"%d, ", b->steps_x);
-    if(b->direction_bits & (1<<Y_DIRECTION_BIT)) fprintf(block_out_file,"-");
-    fprintf(block_out_file,"%d, ", b->steps_y);
-    if(b->direction_bits & (1<<Z_DIRECTION_BIT)) fprintf(block_out_file,"-");
-    fprintf(block_out_file,"%d, ", b->steps_z);
-    fprintf(block_out_file,"%f", b->nominal_speed);
-    fprintf(block_out_file,"\n");
-
-    last_block= b;
+void sim_init() {
+  if(block_out_file)
+    fprintf(block_out_file, "time,block,steps_x,steps_y,steps_z,step_events,millimeters,"
+        "nominal_speed,entry_speed,max_entry_speed,initial_rate,nominal_rate,final_rate,"
+        "rate_delta,accelerate_until,decelerate_after\n");
+  if(step_out_file) {
+    fprintf(step_out_file, "time,block,x,y,z\n");
+    print_position();
   }
+  memcpy(counted_position, sys.position, sizeof(counted_position));
+  i386_set_interrupt_hook(sim_interrupt);
 }
 
-// The simulator assumes that grbl is fast enough to keep the buffer full.
-// Thus, the stepper interrupt is only called when the buffer is full and then only to
-// finish one block.
-// Only when plan_synchronize() wait for the whole buffer to clear, the stepper interrupt
-// to finish all pending moves.
-void handle_buffer() {
-  // runtime_second_call is reset by serial_write() after every command.
-  // Only when execute_runtime() is called repeatedly by plan_synchronize()
-  // runtime_second_call will be incremented above 2
-  if(plan_check_full_buffer() || runtime_second_call>2) {
-    sim_stepper(step_out_file);
-  } else {
-    runtime_second_call++;
+void sim_finish() {
+  i386_set_interrupt_hook(NULL);
+  if(step_out_file) {
+    print_position();
+    fclose(step_out_file);
+  }
+  if(block_out_file) fclose(block_out_file);
+  if(summary_out_file) {
+    fprintf(summary_out_file, "time,blocks,x,y,z,steps_x,steps_y,steps_z\n"
+        "%.9f,%" PRIu32 ",%" PRId32 ",%" PRId32 ",%" PRId32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 "\n",
+        sim_time(), block_count, sys.position[X_AXIS], sys.position[Y_AXIS], sys.position[Z_AXIS],
+        step_count[X_AXIS], step_count[Y_AXIS], step_count[Z_AXIS]);
+    fclose(summary_out_file);
   }
 }
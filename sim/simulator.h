@@ -1,6 +1,6 @@
 /*
-  simulator.h - functions to simulate how the buffer is emptied and the
-    stepper interrupt is called
+  simulator.h - records the plan and the stepper trajectory as grbl executes
+    them on the hosting HAL
 
   Part of Grbl Simulator
 
@@ -24,30 +24,20 @@
 #define simulator_h
 
 #include <stdio.h>
-#include "../nuts_bolts.h"
 
-// Output file handles
+// Output file handles, any may be NULL for no output
 extern FILE *block_out_file;
 extern FILE *step_out_file;
+extern FILE *summary_out_file;
 
-// This variable is needed to determine if execute_runtime() is called in a loop
-// waiting for the buffer to empty, as in plan_synchronize()
-extern int runtime_second_call;
-
-// Minimum time step for printing stepper values. Given by user via command line
+// Minimum time step between stepper position rows, in seconds. Zero records
+// every step interrupt that moved an axis.
 extern double step_time;
 
-// global system variable structure for position etc.
-extern system_t sys;
-
-
-// Call the stepper interrupt until one block is finished
-void sim_stepper();
-
-// Check if buffer is full or if plan_synchronize() wants to clear the buffer
-void handle_buffer();
+// Writes the CSV headers and starts watching the stepper interrupt
+void sim_init();
 
-// Print information about the most recently inserted block
-void printBlock();
+// Records the final position and closes the output files
+void sim_finish();
 
 #endif
@@ -25,7 +25,7 @@
 
 #include "spindle_control.h"
 
-#include "planner.h"
+#include "motion_control.h"
 
 
 static uint8_t current_direction;
@@ -33,7 +33,7 @@ static uint8_t current_direction;
 void spindle_stop(void) {
   /* If we were spinning, we need to wait until all previous moves are executed
    * before stopping. */
-  if(current_direction) plan_synchronize();
+  if(current_direction) mc_synchronize();
   host_gpio_write(SPINDLE_ENABLE, false, HOST_GPIO_MODE_BIT);
 }
 
@@ -50,7 +50,7 @@ void spindle_run(int8_t direction) {
   /* If we need to change state, we must wait for all moves to complete before
    * doing so. */
   if(direction != current_direction) {
-    plan_synchronize();
+    mc_synchronize();
     if(direction != SPINDLE_STOP) {
       #ifdef SPINDLE_DIRECTION
         if(direction == SPINDLE_CW)
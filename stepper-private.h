@@ -15,6 +15,22 @@
 // Some useful constants
 #define TICKS_PER_MICROSECOND (HOST_TIMER_FOSC / 1000000)
 #define CYCLES_PER_ACCELERATION_TICK (HOST_TIMER_FOSC / ACCELERATION_TICKS_PER_SECOND)
+#define CYCLES_PER_TELEMETRY_TICK (HOST_TIMER_FOSC / PLAN_TELEMETRY_TICKS_PER_SECOND)
+
+// Step rate to timer reload conversion table. Rates are normalized by shifting
+// into [0x8000, 0x10000) steps/minute and entry i holds the number of cycles
+// per step event at a rate of 0x8000 + 0x100 * i steps/minute, rounded. The
+// last entry only serves as the upper interpolation bound for the one before.
+#if HOST_TIMER_FOSC * 60 >= 0x80000000UL
+# error HOST_TIMER_FOSC too high for the step rate conversion table
+#endif
+#define STEP_RATE_LUT_BITS 7
+#define STEP_RATE_LUT_SIZE ((1 << STEP_RATE_LUT_BITS) + 1)
+#define STEP_RATE_LUT_ENTRY(i) ((HOST_TIMER_FOSC * 60 + (0x8000UL + 0x100UL * (i)) / 2) / \
+    (0x8000UL + 0x100UL * (i)))
+#define _LUT4(i) STEP_RATE_LUT_ENTRY(i), STEP_RATE_LUT_ENTRY((i) + 1), \
+    STEP_RATE_LUT_ENTRY((i) + 2), STEP_RATE_LUT_ENTRY((i) + 3)
+#define _LUT16(i) _LUT4(i), _LUT4((i) + 4), _LUT4((i) + 8), _LUT4((i) + 12)
 
 // Stepper state variable. Contains running data and trapezoid variables.
 typedef struct {
@@ -32,9 +48,14 @@ typedef struct {
 } stepper_t;
 
 // Local functions
+static uint32_t cycles_per_step_event(uint32_t steps_per_minute);
 static void set_step_events_per_minute(uint32_t steps_per_minute);
 static void st_wake_up(void);
 static uint8_t iterate_trapezoid_cycle_counter(void);
+#ifdef STEPPER_ISR_TIMING
+static void timing_clear(void);
+static void timing_sample(uint32_t cycles);
+#endif
 
 
 #endif /* STEPPER_PRIVATE_H_ */
@@ -43,6 +43,19 @@ static volatile uint8_t busy;        // True when OCIE1A is being serviced. Used
 #if STEP_PULSE_DELAY > 0
   static stepper_output_t step_bits; // Stores out_bits output to complete the step pulse delay
 #endif
+#ifdef STEPPER_ISR_TIMING
+  static stepper_timing_t timing;    // Step interrupt execution time statistics
+  static int32_t timing_reload_offset; // Elapsed cycles lost to prescaler changes in this interrupt
+#endif
+#ifdef PLANNER_TELEMETRY
+  static uint32_t telemetry_tick_cycle_counter; // The cycles since last planner telemetry tick
+#endif
+// Cycles per step event, see STEP_RATE_LUT_ENTRY()
+static const uint16_t _T_t(step_rate_lut[STEP_RATE_LUT_SIZE]) = {
+  _LUT16(0), _LUT16(16), _LUT16(32), _LUT16(48),
+  _LUT16(64), _LUT16(80), _LUT16(96), _LUT16(112),
+  STEP_RATE_LUT_ENTRY(128)
+};
 
 //         __________________________
 //        /|                        |\     _________________         ^
@@ -62,12 +75,84 @@ static volatile uint8_t busy;        // True when OCIE1A is being serviced. Used
  * The slope of acceleration is always +/- block->rate_delta and is applied at
  * a constant rate following the midpoint rule by the trapezoid generator, which
  * is called ACCELERATION_TICKS_PER_SECOND times per second. */
+// Converts a step rate into the number of cycles between step events, i.e.
+// (HOST_TIMER_FOSC * 60) / steps_per_minute, without dividing. The rate is
+// normalized into the range covered by step_rate_lut and the result linearly
+// interpolated between two adjacent entries using an 8x16 bit multiply, then
+// scaled back. The result stays within about 0.01% or one cycle of the exact one.
+static uint32_t cycles_per_step_event(uint32_t steps_per_minute) {
+  uint8_t shift = 0, index;
+  uint16_t lower, delta;
+  uint32_t cycles;
+
+  if(steps_per_minute < MINIMUM_STEPS_PER_MINUTE)
+    steps_per_minute = MINIMUM_STEPS_PER_MINUTE;
+  if(steps_per_minute < 0x8000UL) {
+    do { steps_per_minute <<= 1; shift++; } while(steps_per_minute < 0x8000UL);
+    index = (steps_per_minute >> 8) & 0x7F;
+  } else {
+    while(steps_per_minute >= 0x10000UL) { steps_per_minute >>= 1; shift++; }
+    index = (steps_per_minute >> 8) & 0x7F;
+    shift |= 0x80; // Result needs scaling down rather than up
+  }
+  lower = host_fetch_W(&step_rate_lut[index]);
+  delta = lower - host_fetch_W(&step_rate_lut[index + 1]);
+  cycles = lower - ((delta * (uint8_t)((steps_per_minute >> 1) & 0x7F)) >> 7);
+
+  if(shift & 0x80) return cycles >> (shift & 0x7F);
+  else return cycles << shift;
+}
+
 static void set_step_events_per_minute(uint32_t steps_per_minute) {
-  host_timer_set_reload(1,
-      (HOST_TIMER_FOSC * 60) / (steps_per_minute < MINIMUM_STEPS_PER_MINUTE ?
-          MINIMUM_STEPS_PER_MINUTE : steps_per_minute),
+  #ifdef STEPPER_ISR_TIMING
+    // The reload may change the prescaler, after which the counter no longer
+    // converts to cycles with the old shift. Keep the difference of the two
+    // readings so the end of interrupt sample still covers the whole handler.
+    timing_reload_offset += host_timer_get_elapsed_cycles(1);
+  #endif
+  host_timer_set_reload(1, cycles_per_step_event(steps_per_minute),
       st.cycles_per_step_event);
+  #ifdef STEPPER_ISR_TIMING
+    timing_reload_offset -= host_timer_get_elapsed_cycles(1);
+  #endif
+}
+
+#ifdef STEPPER_ISR_TIMING
+static void timing_clear(void) {
+  memset(&timing, 0, sizeof(timing));
+  timing.min_cycles = UINT32_MAX;
+  timing.min_period = UINT32_MAX;
+}
+
+// Accounts for one run of the step interrupt which took cycles to get here.
+// Everything is shifts, compares and adds so the cost stays small and fixed.
+static void timing_sample(uint32_t cycles) {
+  uint8_t bin = 0;
+  uint32_t coarse = cycles >> 8;
+
+  if(host_timer_interrupt_pending(1, HOST_TIMER_INTERRUPT_COMPARE_A) &&
+      timing.late < UINT16_MAX) timing.late++;
+  if(cycles < timing.min_cycles) timing.min_cycles = cycles;
+  if(cycles > timing.max_cycles) {
+    timing.max_cycles = cycles;
+    timing.max_period = st.cycles_per_step_event;
+  }
+  if(st.cycles_per_step_event < timing.min_period)
+    timing.min_period = st.cycles_per_step_event;
+  if(timing.total_cycles & 0x80000000UL) {
+    timing.total_cycles >>= 1;
+    timing.total_samples >>= 1;
+  }
+  timing.total_cycles += cycles;
+  timing.total_samples++;
+  timing.samples++;
+  while(coarse && bin < STEPPER_TIMING_BINS - 1) {
+    coarse >>= 1;
+    bin++;
+  }
+  if(timing.histogram[bin] < UINT16_MAX) timing.histogram[bin]++;
 }
+#endif
 
 // Stepper state initialization
 static void st_wake_up(void) {
@@ -109,6 +194,13 @@ void st_go_idle(void) {
   #endif
 }
 
+// Stepper emergency stop. Axes stay locked if STEPPERS_DISABLE is in use, the
+// main program puts them to rest while it resets the system.
+void st_abort(void) {
+  host_timer_disable_interrupt(1, HOST_TIMER_INTERRUPT_COMPARE_A);
+  sys.cycle_start = false;
+}
+
 // This function determines an acceleration velocity change every CYCLES_PER_ACCELERATION_TICK by
 // keeping track of the number of elapsed cycles during a de/ac-celeration. The code assumes that 
 // step_events occur significantly more often than the acceleration velocity iterations.
@@ -128,7 +220,15 @@ inline static uint8_t iterate_trapezoid_cycle_counter(void) {
  * algorithm controls all three stepper outputs simultaneously with these two
  *  interrupts. */
 HOST_INTERRUPT(host_timer_vector_name(1, HOST_TIMER_INTERRUPT_COMPARE_A)) {
-  if(busy) return; // The busy-flag is used to avoid reentering this interrupt
+  if(busy) { // The busy-flag is used to avoid reentering this interrupt
+    #ifdef STEPPER_ISR_TIMING
+      if(timing.busy_rejections < UINT16_MAX) timing.busy_rejections++;
+    #endif
+    return;
+  }
+  #ifdef STEPPER_ISR_TIMING
+    timing_reload_offset = 0;
+  #endif
 
   // Set the direction pins a couple of nanoseconds before we step the steppers
   host_gpio_write(DIR_X, out_bits.flags.dir_x, HOST_GPIO_MODE_BIT);
@@ -171,6 +271,9 @@ HOST_INTERRUPT(host_timer_vector_name(1, HOST_TIMER_INTERRUPT_COMPARE_A)) {
       st.event_count = current_block->step_event_count;
       st.step_events_completed = 0;     
     } else {
+      #ifdef PLANNER_TELEMETRY
+        plan_telemetry_underrun();
+      #endif
       st_go_idle();
       sys.cycle_start = false;
       bit_true(sys.execute, EXEC_CYCLE_STOP); // Flag main program for cycle end
@@ -203,6 +306,14 @@ HOST_INTERRUPT(host_timer_vector_name(1, HOST_TIMER_INTERRUPT_COMPARE_A)) {
     }
     
     st.step_events_completed++; // Iterate step events
+    #ifdef PLANNER_TELEMETRY
+      // Sample planner buffer occupancy at a steady pace while in motion
+      telemetry_tick_cycle_counter += st.cycles_per_step_event;
+      while(telemetry_tick_cycle_counter > CYCLES_PER_TELEMETRY_TICK) {
+        telemetry_tick_cycle_counter -= CYCLES_PER_TELEMETRY_TICK;
+        plan_telemetry_tick();
+      }
+    #endif
 
     // While in block steps, check for de/ac-celeration events and execute them accordingly.
     if(st.step_events_completed < current_block->step_event_count) {
@@ -297,6 +408,11 @@ HOST_INTERRUPT(host_timer_vector_name(1, HOST_TIMER_INTERRUPT_COMPARE_A)) {
     }
   }
   out_bits.value ^= settings.invert.masks.stepdir;  // Apply stepper invert mask
+  #ifdef STEPPER_ISR_TIMING
+    // Only account for step events, going idle includes the stepper lock delay
+    if(sys.cycle_start)
+      timing_sample(host_timer_get_elapsed_cycles(1) + timing_reload_offset);
+  #endif
   busy = false;
 }
 
@@ -336,6 +452,16 @@ void st_reset(void) {
   busy = false;
 }
 
+#ifdef STEPPER_ISR_TIMING
+// Copies and clears the step interrupt timing statistics
+void st_timing_fetch(stepper_timing_t *result) {
+  host_cli();
+  *result = timing;
+  timing_clear();
+  host_sei();
+}
+#endif
+
 // Initialize and start the stepper motor subsystem
 void st_init(void) {
   host_gpio_direction(STEP_X, HOST_GPIO_DIRECTION_OUTPUT, HOST_GPIO_MODE_BIT);
@@ -366,6 +492,9 @@ void st_init(void) {
   #if STEP_PULSE_DELAY > 0
     host_register_interrupt(host_timer_vector_name(2, HOST_TIMER_INTERRUPT_COMPARE_A));
   #endif
+  #ifdef STEPPER_ISR_TIMING
+    timing_clear();
+  #endif
   // Start in the idle state
   st_go_idle();
 
@@ -40,12 +40,30 @@ typedef union {
   uint8_t value;
 } stepper_output_t;
 
+// Step interrupt execution time statistics, see STEPPER_ISR_TIMING in config.h
+#define STEPPER_TIMING_BINS 8 // Histogram bin n counts durations under 256 << n cycles, last one the rest
+typedef struct {
+  uint32_t min_cycles;      // Shortest step interrupt seen, in CPU cycles
+  uint32_t max_cycles;      // Longest step interrupt seen, in CPU cycles
+  uint32_t max_period;      // Step period in force when max_cycles was seen, in CPU cycles
+  uint32_t min_period;      // Shortest step period seen, in CPU cycles
+  uint32_t total_cycles;    // Sum of total_samples durations, halved with it before overflowing
+  uint32_t total_samples;
+  uint32_t samples;         // Number of step interrupts measured
+  uint16_t busy_rejections; // Times the interrupt fired while still busy and had to bail out
+  uint16_t late;            // Times the next compare match came before the handler was done
+  uint16_t histogram[STEPPER_TIMING_BINS];
+} stepper_timing_t;
+
 // Initialize and setup the stepper motor subsystem
 void st_init(void);
 
 // Immediately disables steppers
 void st_go_idle(void);
 
+// Stops stepping right away, without the stepper idle lock delay. Safe to call from interrupts.
+void st_abort(void);
+
 // Reset the stepper subsystem variables
 void st_reset(void);
 
@@ -58,5 +76,8 @@ void st_cycle_reinitialize(void);
 // Initiates a feed hold of the running program
 void st_feed_hold(void);
 
+// Copies and clears the step interrupt timing statistics
+void st_timing_fetch(stepper_timing_t *result);
+
 
 #endif